@@ -17,9 +17,25 @@
  * getNumStorageTiers(dataCenter)                       - number of Storage Tiers in dataCenter (int)
  * getNumStorageTiers(idx)                              - number of Storage Tiers in idx-th Data Center (int)
  * getIdxStorageTiers(dataCenter, storageTier, option)  - index of (dataCenter, storageTier) (int); option = "all" or "dataCenter"
+ * getDataCenterIdx(idx)                                - index of Data Center of idx-th Storage Tier (int)
+ * getStorageTierIdx(idx)                               - index of idx-th Storage Tier within its Data Center (int)
+ * getIdxCenter()                                       - index of central DC location (int)
+ * hasCenter()                                          - whether the central DC location is one of the Data Centers (bool)
+
+ * Int-indexed getters (compiled by update() and invalid after any setter until the next update();
+ *                      k, k1, k2 index Data Centers and t indexes Storage Tiers)
+ ===============================================================================================================
+ * getNetworkCost(k1, k2), getNetworkLatency(k1, k2)    - network cost/latency between k1-th and k2-th Data Center
+ * getStorageCost(t), getGetCost(t), getPutCost(t)      - storage/get request/put request cost of t-th Storage Tier
+ * getRetrieveCost(t), getWriteCost(t)                  - data retrieval/write cost of t-th Storage Tier
+ * getGetLatency(t), getPutLatency(t)                   - get/put latency of t-th Storage Tier
+ * getSize(k), getGetRequest(k), getPutRequest(k)       - average object size/number of get/put request in k-th Data Center
  
  * readJSON(cost_info, monitoring_info, query, goals)   - set up gdss instance from JSON files
  * setInstance(dcList)                                  - set up a random gdss instance from a list of Storage Tiers dcList
+ * setQuery(query_data)                                 - replace object size and requests with those of a query JSON object
+ * setGoals(goals_data)                                 - replace goals with those of a goals JSON object
+ * getGoals()                                           - current goals as a goals JSON object
  */
 
 #pragma once
@@ -56,6 +72,7 @@ public:
         else {
             throw std::runtime_error("ERROR: " + storageTier + " already exists in " + dataCenter);
         }
+        dirty = true;
     }
 
     // Get list of all Data Centers
@@ -87,6 +104,7 @@ public:
         }
 
         networkCost[std::make_pair(dataCenter1, dataCenter2)] = cost;
+        dirty = true;
     }
 
     // Get network cost betwen dataCenter1 and dataCenter2
@@ -117,6 +135,7 @@ public:
         }
 
         storageCost[std::make_pair(dataCenter, storageTier)] = cost;
+        dirty = true;
     }
 
     // Get storage cost of storageTier in dataCenter
@@ -147,6 +166,7 @@ public:
         }
 
         getCost[std::make_pair(dataCenter, storageTier)] = cost;
+        dirty = true;
     }
 
     // Get get request cost of storageTier in dataCenter
@@ -177,6 +197,7 @@ public:
         }
 
         putCost[std::make_pair(dataCenter, storageTier)] = cost;
+        dirty = true;
     }
 
     // Get put request cost of storageTier in dataCenter
@@ -207,6 +228,7 @@ public:
         }
 
         retrieveCost[std::make_pair(dataCenter, storageTier)] = cost;
+        dirty = true;
     }
 
     // Get data retrieval cost of storageTier in dataCenter
@@ -237,6 +259,7 @@ public:
         }
 
         writeCost[std::make_pair(dataCenter, storageTier)] = cost;
+        dirty = true;
     }
 
     // Get data write cost of storageTier in dataCenter
@@ -341,6 +364,7 @@ public:
             throw std::runtime_error("ERROR: Data center " + dataCenter + " does not exist");
         }
         center = dataCenter;
+        dirty = true;
     }
 
     // Get central DC location
@@ -365,6 +389,7 @@ public:
         }
 
         aveSize[dataCenter] = size;
+        dirty = true;
     }
 
     // Get average object size in dataCenter
@@ -397,6 +422,7 @@ public:
         }
 
         networkLatency[std::make_pair(dataCenter1, dataCenter2)] = latency;
+        dirty = true;
     }
 
     // Get network latency betwen dataCenter1 and dataCenter2
@@ -427,6 +453,7 @@ public:
         }
 
         getLatency[std::make_pair(dataCenter, storageTier)] = latency;
+        dirty = true;
     }
 
     // Get get latency of storageTier in dataCenter
@@ -457,6 +484,7 @@ public:
         }
 
         putLatency[std::make_pair(dataCenter, storageTier)] = latency;
+        dirty = true;
     }
 
     // Get get latency of storageTier in dataCenter
@@ -488,6 +516,7 @@ public:
         }
 
         getRequest[dataCenter] = request;
+        dirty = true;
     }
 
     // Get number of get request in dataCenter
@@ -512,6 +541,7 @@ public:
         }
 
         putRequest[dataCenter] = request;
+        dirty = true;
     }
 
     // Get number of put request in dataCenter
@@ -531,22 +561,112 @@ private:
     std::vector<std::pair<std::string,std::string>> idxToStorage;
     std::map<std::string,int> dataToIdx;
 
+    // Compiled read-only view of the parameters, rebuilt by update()
+    std::vector<int> idxToDataCenter, idxToTier;                                    // indexed by t
+    std::vector<Cost> networkCostTable;                                             // indexed by k1 * numDC + k2
+    std::vector<Latency> networkLatencyTable;                                       // indexed by k1 * numDC + k2
+    std::vector<Cost> storageCostTable, getCostTable, putCostTable;                 // indexed by t
+    std::vector<Cost> retrieveCostTable, writeCostTable;                            // indexed by t
+    std::vector<Latency> getLatencyTable, putLatencyTable;                          // indexed by t
+    std::vector<Size> sizeTable;                                                    // indexed by k
+    std::vector<Request> getRequestTable, putRequestTable;                          // indexed by k
+    int idxCenter = -1;
+    bool dirty = true;                                                              // set by every setter, cleared by update()
+
+    // Check that the int-indexed tables are up to date
+    void checkUpdated() const {
+        if (dirty) {
+            throw std::runtime_error("ERROR: Parameters changed since last update()");
+        }
+    }
+
+    // Check that the tables are up to date and k indexes a Data Center
+    void checkDataCenterIdx(int k) const {
+        checkUpdated();
+        if (k < 0 || k >= getNumDataCenters()) {
+            throw std::runtime_error("ERROR: index should be less than " + std::to_string(getNumDataCenters()));
+        }
+    }
+
+    // Check that the tables are up to date and t indexes a Storage Tier
+    void checkStorageTierIdx(int t) const {
+        checkUpdated();
+        if (t < 0 || t >= getNumStorageTiers()) {
+            throw std::runtime_error("ERROR: index should be less than " + std::to_string(getNumStorageTiers()));
+        }
+    }
+
+    // Look up key in a string-keyed parameter map, 0 if not yet set
+    template<typename K, typename V>
+    static V lookup(std::map<K,V> const& table, K const& key) {
+        auto it = table.find(key);
+        return it != table.end() ? it->second : V(0);
+    }
+
 public:
-    // Mapping Data Centers and Storage Tiers to int
+    // Mapping Data Centers and Storage Tiers to int and compiling the int-indexed tables
     void update() {
         storageToIdx.clear();
         idxToStorage.clear();
         dataToIdx.clear();
+        idxToDataCenter.clear();
+        idxToTier.clear();
         int idx = 0;
 
         for (std::string dataCenter: dataCenters) {
+            int tier = 0;
             for (std::string storageTier: storageTiers[dataCenter]) {
                 storageToIdx[std::make_pair(dataCenter, storageTier)] = idxToStorage.size();
                 idxToStorage.push_back(std::make_pair(dataCenter, storageTier));
+                idxToDataCenter.push_back(idx);
+                idxToTier.push_back(tier++);
             }
             dataToIdx[dataCenter] = idx;
             idx ++;
         }
+
+        int numDC = getNumDataCenters();
+        int numST = getNumStorageTiers();
+
+        networkCostTable.assign(numDC * numDC, 0);
+        networkLatencyTable.assign(numDC * numDC, 0);
+        for (int k1 = 0; k1 < numDC; ++k1) {
+            for (int k2 = 0; k2 < numDC; ++k2) {
+                std::pair<std::string,std::string> key = std::make_pair(dataCenters[k1], dataCenters[k2]);
+                networkCostTable[k1 * numDC + k2] = lookup(networkCost, key);
+                networkLatencyTable[k1 * numDC + k2] = lookup(networkLatency, key);
+            }
+        }
+
+        storageCostTable.assign(numST, 0);
+        getCostTable.assign(numST, 0);
+        putCostTable.assign(numST, 0);
+        retrieveCostTable.assign(numST, 0);
+        writeCostTable.assign(numST, 0);
+        getLatencyTable.assign(numST, 0);
+        putLatencyTable.assign(numST, 0);
+        for (int t = 0; t < numST; ++t) {
+            std::pair<std::string,std::string> const& key = idxToStorage[t];
+            storageCostTable[t] = lookup(storageCost, key);
+            getCostTable[t] = lookup(getCost, key);
+            putCostTable[t] = lookup(putCost, key);
+            retrieveCostTable[t] = lookup(retrieveCost, key);
+            writeCostTable[t] = lookup(writeCost, key);
+            getLatencyTable[t] = lookup(getLatency, key);
+            putLatencyTable[t] = lookup(putLatency, key);
+        }
+
+        sizeTable.assign(numDC, 0);
+        getRequestTable.assign(numDC, 0);
+        putRequestTable.assign(numDC, 0);
+        for (int k = 0; k < numDC; ++k) {
+            sizeTable[k] = lookup(aveSize, dataCenters[k]);
+            getRequestTable[k] = lookup(getRequest, dataCenters[k]);
+            putRequestTable[k] = lookup(putRequest, dataCenters[k]);
+        }
+
+        idxCenter = dataToIdx.count(center) ? dataToIdx.at(center) : -1;
+        dirty = false;
     }
 
     // Get number of Data Centers
@@ -621,6 +741,107 @@ public:
         throw std::runtime_error("ERROR: Invalid option parameter");
     }
 
+    // Get index of Data Center of idx-th Storage Tier
+    int getDataCenterIdx(int idx) const {
+        checkStorageTierIdx(idx);
+        return idxToDataCenter[idx];
+    }
+
+    // Get index of idx-th Storage Tier within its Data Center
+    int getStorageTierIdx(int idx) const {
+        checkStorageTierIdx(idx);
+        return idxToTier[idx];
+    }
+
+    // Check if the central DC location is one of the Data Centers
+    bool hasCenter() const {
+        checkUpdated();
+        return idxCenter != -1;
+    }
+
+    // Get index of central DC location
+    int getIdxCenter() const {
+        checkUpdated();
+        if (idxCenter == -1) {
+            throw std::runtime_error("ERROR: Centralized DC location does not exist");
+        }
+        return idxCenter;
+    }
+
+    // Get network cost between k1-th and k2-th Data Center
+    Cost getNetworkCost(int k1, int k2) const {
+        checkDataCenterIdx(k1);
+        checkDataCenterIdx(k2);
+        return networkCostTable[k1 * getNumDataCenters() + k2];
+    }
+
+    // Get network latency between k1-th and k2-th Data Center
+    Latency getNetworkLatency(int k1, int k2) const {
+        checkDataCenterIdx(k1);
+        checkDataCenterIdx(k2);
+        return networkLatencyTable[k1 * getNumDataCenters() + k2];
+    }
+
+    // Get storage cost of t-th Storage Tier
+    Cost getStorageCost(int t) const {
+        checkStorageTierIdx(t);
+        return storageCostTable[t];
+    }
+
+    // Get get request cost of t-th Storage Tier
+    Cost getGetCost(int t) const {
+        checkStorageTierIdx(t);
+        return getCostTable[t];
+    }
+
+    // Get put request cost of t-th Storage Tier
+    Cost getPutCost(int t) const {
+        checkStorageTierIdx(t);
+        return putCostTable[t];
+    }
+
+    // Get data retrieval cost of t-th Storage Tier
+    Cost getRetrieveCost(int t) const {
+        checkStorageTierIdx(t);
+        return retrieveCostTable[t];
+    }
+
+    // Get data write cost of t-th Storage Tier
+    Cost getWriteCost(int t) const {
+        checkStorageTierIdx(t);
+        return writeCostTable[t];
+    }
+
+    // Get get latency of t-th Storage Tier
+    Latency getGetLatency(int t) const {
+        checkStorageTierIdx(t);
+        return getLatencyTable[t];
+    }
+
+    // Get put latency of t-th Storage Tier
+    Latency getPutLatency(int t) const {
+        checkStorageTierIdx(t);
+        return putLatencyTable[t];
+    }
+
+    // Get average object size in k-th Data Center
+    Size getSize(int k) const {
+        checkDataCenterIdx(k);
+        return sizeTable[k];
+    }
+
+    // Get number of get request in k-th Data Center
+    Request getGetRequest(int k) const {
+        checkDataCenterIdx(k);
+        return getRequestTable[k];
+    }
+
+    // Get number of put request in k-th Data Center
+    Request getPutRequest(int k) const {
+        checkDataCenterIdx(k);
+        return putRequestTable[k];
+    }
+
 public:
     // Check if all information required are present
     void checkAll() const {
@@ -701,6 +922,8 @@ public:
         setSLAPut(3.5);
         setLC(std::ceil(getNumDataCenters() / 2));
         setF(getNumDataCenters() / 2 - 1);
+
+        update();
     }
 
     // Read information from JSON file
@@ -750,25 +973,66 @@ public:
         // Size/Request information
         std::ifstream h(query);
         json query_data = json::parse(h);
-        for (auto& dataCenter : dataCenters) {
-            setSize(dataCenter, query_data["object_size"].get<Size>());
-        }
-        for (auto& regions : query_data["access_info"].items()) {
-            json region = regions.value();
-            setGetRequest(regions.key(), region["get_access_cnt"].get<Request>());
-            setPutRequest(regions.key(), region["put_access_cnt"].get<Request>());
-        }
+        readQuery(query_data);
 
         // Goal information
         std::ifstream i(goals);
         json goals_data = json::parse(i);
+        readGoals(goals_data);
+
+        update();
+    }
+
+    // Replace goals with those of goals_data
+    void setGoals(json const& goals_data) {
+        center = "";
+        slaGet = -1;
+        slaPut = -1;
+        localeCount = -1;
+        faults = -1;
+        readGoals(goals_data);
+        update();
+    }
+
+    // Get goals in the format of goals_data
+    json getGoals() const {
+        json goals_data;
+        goals_data["center"] = getCenter();
+        goals_data["get_sla"] = getSLAGet();
+        goals_data["put_sla"] = getSLAPut();
+        goals_data["lc"] = getLC();
+        goals_data["degree_of_fault"] = getF();
+        return goals_data;
+    }
+
+    // Replace object size and requests with those of query_data
+    void setQuery(json const& query_data) {
+        aveSize.clear();
+        getRequest.clear();
+        putRequest.clear();
+        readQuery(query_data);
+        update();
+    }
+
+private:
+    // Read goal information from goals_data
+    void readGoals(json const& goals_data) {
         setCenter(goals_data["center"].get<std::string>());
         setSLAGet(goals_data["get_sla"].get<Latency>());
         setSLAPut(goals_data["put_sla"].get<Latency>());
         setLC(goals_data["lc"].get<int>());
         setF(goals_data["degree_of_fault"].get<int>());
-
-        update();
     }
 
+    // Read size/request information from query_data
+    void readQuery(json const& query_data) {
+        for (auto& dataCenter : dataCenters) {
+            setSize(dataCenter, query_data["object_size"].get<Size>());
+        }
+        for (auto& regions : query_data["access_info"].items()) {
+            json region = regions.value();
+            setGetRequest(regions.key(), region["get_access_cnt"].get<Request>());
+            setPutRequest(regions.key(), region["put_access_cnt"].get<Request>());
+        }
+    }
 };
\ No newline at end of file
@@ -11,6 +11,7 @@
 
 #include <tdzdd/DdEval.hpp>
 
+#include "VariableLayout.hpp"
 #include "GeoDistributedStorageSystem.hpp"
 
 typedef GeoDistributedStorageSystem::Cost Cost;
@@ -22,6 +23,7 @@ namespace tdzdd {
 class GetConfig: public DdEval<GetConfig,CostConfigPair> {
 private:    
     GeoDistributedStorageSystem const& gdss;
+    VariableLayout const& layout;
     int const Pwidth;
     int const Twidth;
     int const numDC;
@@ -32,10 +34,10 @@ private:
     TLL invalidTLL;
 
 public:
-    GetConfig(GeoDistributedStorageSystem const& gdss) 
-        : gdss(gdss), numDC(gdss.getNumDataCenters()), numST(gdss.getNumStorageTiers()),
+    GetConfig(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout) 
+        : gdss(gdss), layout(layout),
           Pwidth(1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters()),
-          Twidth(1 + gdss.getNumDataCenters()), 
+          Twidth(1 + gdss.getNumDataCenters()), numDC(gdss.getNumDataCenters()), numST(gdss.getNumStorageTiers()),
           n(gdss.getNumStorageTiers() * (1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters())) {
     }
 
@@ -45,17 +47,15 @@ public:
 
     void evalNode(CostConfigPair &v, int level, DdValues<CostConfigPair,2> const& values) {
         assert(1 <= level && level <= n);
-        int invLevel = n - level;
+        VariableLayout::Variable const& var = layout[level];
+        int i = var.i, j = var.j, k = var.k, t = var.t;
         
         // P_{kt}
-        if (invLevel % Pwidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-
-            Cost currCost = gdss.getSize(DCk) * gdss.getStorageCost(DCk, STt);
+        if (var.kind == VariableLayout::P) {
+            Cost currCost = gdss.getSize(k) * gdss.getStorageCost(t);
             if (values.get(0).first > values.get(1).first + currCost) {
+                std::string DCk = gdss.getStorageTiers(t, "dataCenter");
+                std::string STt = gdss.getStorageTiers(t, "storageTier");
                 v = values.get(1);
                 v.first += currCost;
                 v.second["storageTiers"].push_back("{" + DCk + ", " + STt + "}");
@@ -65,17 +65,13 @@ public:
             }
         }
         // T_{jkt}
-        else if ((invLevel % Pwidth - 1) % Twidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            std::string DCj = gdss.getDataCenters(j);
-
-            Cost currCost = (gdss.getGetRequest(DCj) * (gdss.getSize(DCj) * (gdss.getNetworkCost(DCk, DCj) + gdss.getRetrieveCost(DCk, STt)) + gdss.getGetCost(DCk, STt)) +
-                                gdss.getPutRequest(DCj) * (gdss.getSize(DCj) * (gdss.getNetworkCost(DCj, DCk) + gdss.getWriteCost(DCk, STt)) + gdss.getPutCost(DCk, STt)));
+        else if (var.kind == VariableLayout::T) {
+            Cost currCost = (gdss.getGetRequest(j) * (gdss.getSize(j) * (gdss.getNetworkCost(k, j) + gdss.getRetrieveCost(t)) + gdss.getGetCost(t)) +
+                                gdss.getPutRequest(j) * (gdss.getSize(j) * (gdss.getNetworkCost(j, k) + gdss.getWriteCost(t)) + gdss.getPutCost(t)));
             if (values.get(0).first > values.get(1).first + currCost) {
+                std::string DCk = gdss.getStorageTiers(t, "dataCenter");
+                std::string STt = gdss.getStorageTiers(t, "storageTier");
+                std::string DCj = gdss.getDataCenters(j);
                 v = values.get(1);
                 v.first += currCost;
                 if (v.second.count(DCj) == 0) v.second[DCj] = std::vector<std::string>();
@@ -87,16 +83,7 @@ public:
         }
         // B_{ijkt}
         else {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-            int i = (invLevel % Pwidth - 1) % Twidth - 1;
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string DCj = gdss.getDataCenters(j);
-            std::string DCi = gdss.getDataCenters(i);
-            
-            Cost currCost = gdss.getPutRequest(DCi) * (gdss.getSize(DCi) * (gdss.getNetworkCost(DCj, DCk) + gdss.getWriteCost(DCk, STt)) + gdss.getPutCost(DCk, STt));
+            Cost currCost = gdss.getPutRequest(i) * (gdss.getSize(i) * (gdss.getNetworkCost(j, k) + gdss.getWriteCost(t)) + gdss.getPutCost(t));
             if (values.get(0).first > values.get(1).first + currCost) {
                 v = values.get(1);
                 v.first += currCost;
@@ -108,33 +95,23 @@ public:
     }
 };
 
-TLL to_TLL(GeoDistributedStorageSystem const& gdss, std::set<int> config) {
-    int numDC = gdss.getNumDataCenters();
-    int numST = gdss.getNumStorageTiers();
-    int Pwidth = 1 + numDC + numDC * numDC;
-    int Twidth = 1 + numDC;
-    int n = numST * (1 + numDC + numDC * numDC);
+TLL to_TLL(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::set<int> config) {
     TLL targetLocaleList {{"storageTiers", std::vector<std::string>()}};
 
     for (int level: config) {
-        int invLevel = n - level;
+        VariableLayout::Variable const& var = layout[level];
         // P_{kt}
-        if (invLevel % Pwidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
+        if (var.kind == VariableLayout::P) {
+            std::string DCk = gdss.getStorageTiers(var.t, "dataCenter");
+            std::string STt = gdss.getStorageTiers(var.t, "storageTier");
 
             targetLocaleList["storageTiers"].push_back("{" + DCk + ", " + STt + "}");
         }
         // T_{jkt}
-        else if ((invLevel % Pwidth - 1) % Twidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            std::string DCj = gdss.getDataCenters(j);
+        else if (var.kind == VariableLayout::T) {
+            std::string DCk = gdss.getStorageTiers(var.t, "dataCenter");
+            std::string STt = gdss.getStorageTiers(var.t, "storageTier");
+            std::string DCj = gdss.getDataCenters(var.j);
             
             if (targetLocaleList.count(DCj) == 0) targetLocaleList[DCj] = std::vector<std::string>();
             targetLocaleList[DCj].push_back("{" + DCk + ", " + STt + "}"); 
@@ -144,47 +121,26 @@ TLL to_TLL(GeoDistributedStorageSystem const& gdss, std::set<int> config) {
     return targetLocaleList;
 }
 
-std::vector<Cost> getCost(GeoDistributedStorageSystem const& gdss) {
-    int numDC = gdss.getNumDataCenters();
-    int numST = gdss.getNumStorageTiers();
-    int Pwidth = 1 + numDC + numDC * numDC;
-    int Twidth = 1 + numDC;
-    int n = numST * (1 + numDC + numDC * numDC);
+std::vector<Cost> getCost(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout) {
+    int n = layout.numVariables();
     std::vector<Cost> costList(n + 1);
     Cost currCost;
 
     for (int level = 1; level <= n; ++level) {
-        int invLevel = n - level;
+        VariableLayout::Variable const& var = layout[level];
+        int i = var.i, j = var.j, k = var.k, t = var.t;
         // P_{kt}
-        if (invLevel % Pwidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            currCost = gdss.getSize(DCk) * gdss.getStorageCost(DCk, STt);
+        if (var.kind == VariableLayout::P) {
+            currCost = gdss.getSize(k) * gdss.getStorageCost(t);
         }
         // T_{jkt}
-        else if ((invLevel % Pwidth - 1) % Twidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            std::string DCj = gdss.getDataCenters(j);
-            currCost = (gdss.getGetRequest(DCj) * (gdss.getSize(DCj) * (gdss.getNetworkCost(DCk, DCj) + gdss.getRetrieveCost(DCk, STt)) + gdss.getGetCost(DCk, STt)) +
-                        gdss.getPutRequest(DCj) * (gdss.getSize(DCj) * (gdss.getNetworkCost(DCj, DCk) + gdss.getWriteCost(DCk, STt)) + gdss.getPutCost(DCk, STt)));
+        else if (var.kind == VariableLayout::T) {
+            currCost = (gdss.getGetRequest(j) * (gdss.getSize(j) * (gdss.getNetworkCost(k, j) + gdss.getRetrieveCost(t)) + gdss.getGetCost(t)) +
+                        gdss.getPutRequest(j) * (gdss.getSize(j) * (gdss.getNetworkCost(j, k) + gdss.getWriteCost(t)) + gdss.getPutCost(t)));
         }
         // B_{ijkt}
         else {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-            int i = (invLevel % Pwidth - 1) % Twidth - 1;
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string DCj = gdss.getDataCenters(j);
-            std::string DCi = gdss.getDataCenters(i);
-            currCost = gdss.getPutRequest(DCi) * (gdss.getSize(DCi) * (gdss.getNetworkCost(DCj, DCk) + gdss.getWriteCost(DCk, STt)) + gdss.getPutCost(DCk, STt));
+            currCost = gdss.getPutRequest(i) * (gdss.getSize(i) * (gdss.getNetworkCost(j, k) + gdss.getWriteCost(t)) + gdss.getPutCost(t));
         }
 
         costList[level] = currCost;
@@ -0,0 +1,171 @@
+/*
+ * A k-best enumerator for getting optimal configurations/placements in order of cost directly
+ * from the ZDD, following Eppstein's k shortest paths algorithm
+ *
+ * Every root-to-1-terminal path is the minimum-cost path with a sequence of sidetracks, i.e. nodes
+ * where the other branch is taken. Sidetracks along the minimum-cost path from each node are kept in
+ * a persistent leftist heap built lazily from the heap of the next node, so that each placement is
+ * yielded with a constant number of queue operations after a single bottom-up pass
+ */
+
+#pragma once
+
+#include <set>
+#include <queue>
+#include <vector>
+#include <limits>
+#include <unordered_map>
+
+#include <tdzdd/DdStructure.hpp>
+
+#include "MinCostConfig.hpp"
+
+namespace tdzdd {
+
+class KBestConfig {
+    // Node of a persistent leftist heap of sidetracks ordered by additional cost
+    struct Sidetrack {
+        Cost delta;             ///< additional cost of taking the other branch at node
+        NodeId node;
+        int rank;
+        int left;
+        int right;
+    };
+
+    // Placement as its parent placement followed by one more sidetrack
+    struct Path {
+        int sidetrack;          ///< last sidetrack, -1 for the minimum-cost path
+        int parent;
+    };
+
+    struct Candidate {
+        Cost cost;
+        int sidetrack;
+        int parent;
+
+        bool operator<(Candidate const& o) const {
+            return cost > o.cost;
+        }
+    };
+
+    DdStructure<2> const& dd;
+    std::vector<Cost> const weights;    ///< cost of each level; weights[0] is not used
+    MinCostConfig optConfig;
+    std::vector<Sidetrack> heap;
+    std::unordered_map<uint64_t,int> heapOf;   ///< heap of sidetracks along the minimum-cost path from each node
+    std::vector<Path> paths;
+    std::priority_queue<Candidate> candidates;
+    Cost currCost;
+
+    int rank(int h) const {
+        return (h < 0) ? 0 : heap[h].rank;
+    }
+
+    // Merge two heaps without modifying either of them
+    int merge(int h1, int h2) {
+        if (h1 < 0) return h2;
+        if (h2 < 0) return h1;
+        if (heap[h2].delta < heap[h1].delta) std::swap(h1, h2);
+
+        Sidetrack s = heap[h1];
+        s.right = merge(s.right, h2);
+        if (rank(s.left) < rank(s.right)) std::swap(s.left, s.right);
+        s.rank = rank(s.right) + 1;
+        heap.push_back(s);
+        return heap.size() - 1;
+    }
+
+    // Get the heap of sidetracks along the minimum-cost path from node f
+    int heapAt(NodeId f) {
+        std::vector<NodeId> stack;
+        int h = -1;
+        while (f.row() != 0) {
+            std::unordered_map<uint64_t,int>::const_iterator it = heapOf.find(f.code());
+            if (it != heapOf.end()) {
+                h = it->second;
+                break;
+            }
+            stack.push_back(f);
+            f = dd.child(f, optConfig.isTaken(f));
+        }
+
+        while (!stack.empty()) {
+            NodeId g = stack.back();
+            stack.pop_back();
+            bool take = !optConfig.isTaken(g);
+            Cost c = optConfig.getCost(dd.child(g, take));
+            if (c != std::numeric_limits<Cost>::infinity()) {
+                if (take) c += weights[g.row()];
+                heap.push_back(Sidetrack {c - optConfig.getCost(g), g, 1, -1, -1});
+                h = merge(h, heap.size() - 1);
+            }
+            heapOf[g.code()] = h;
+        }
+        return h;
+    }
+
+public:
+    KBestConfig(DdStructure<2> const& dd, std::vector<Cost> const& weights, bool useMP = false)
+        : dd(dd), weights(weights), optConfig(dd, weights, useMP), currCost(optConfig.getCost()) {
+        if (!found()) return;
+        paths.push_back(Path {-1, -1});
+
+        int h = heapAt(dd.root());
+        if (h >= 0) candidates.push(Candidate {currCost + heap[h].delta, h, 0});
+    }
+
+    // Check if there is a current placement
+    bool found() const {
+        return currCost != std::numeric_limits<Cost>::infinity();
+    }
+
+    // Move to the next placement in order of cost
+    void next() {
+        if (candidates.empty()) {
+            currCost = std::numeric_limits<Cost>::infinity();
+            return;
+        }
+
+        Candidate c = candidates.top();
+        candidates.pop();
+        int p = paths.size();
+        paths.push_back(Path {c.sidetrack, c.parent});
+        currCost = c.cost;
+
+        // Replace the last sidetrack with the next cheapest ones in its heap
+        Sidetrack const& s = heap[c.sidetrack];
+        if (s.left >= 0) candidates.push(Candidate {c.cost - s.delta + heap[s.left].delta, s.left, c.parent});
+        if (s.right >= 0) candidates.push(Candidate {c.cost - s.delta + heap[s.right].delta, s.right, c.parent});
+
+        // Append a sidetrack after the last one
+        NodeId f = heap[c.sidetrack].node;
+        int h = heapAt(dd.child(f, !optConfig.isTaken(f)));
+        if (h >= 0) candidates.push(Candidate {c.cost + heap[h].delta, h, p});
+    }
+
+    // Get the cost of the current placement
+    Cost getCost() const {
+        return currCost;
+    }
+
+    // Get the levels taken on the current placement
+    std::set<int> getConfig() const {
+        std::set<int> config;
+        if (!found()) return config;
+
+        std::set<uint64_t> sidetracks;
+        for (int p = paths.size() - 1; paths[p].sidetrack >= 0; p = paths[p].parent) {
+            sidetracks.insert(heap[paths[p].sidetrack].node.code());
+        }
+
+        NodeId f = dd.root();
+        while (f.row() != 0) {
+            bool take = optConfig.isTaken(f) != (sidetracks.count(f.code()) > 0);
+            if (take) config.insert(f.row());
+            f = dd.child(f, take);
+        }
+        return config;
+    }
+};
+
+} // namespace tdzdd
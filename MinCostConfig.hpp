@@ -0,0 +1,209 @@
+/*
+ * A minimum-cost evaluator for getting an optimal configuration/placement for the
+ * Geo-Distributed Multi-Cloud Data Center Storage Tiering and Selection Problem
+ *
+ * MinCost evaluates the minimum cost only; MinCostConfig keeps (cost, chosen branch) per node
+ * and rebuilds the placement of the winning path; MultiMinCostConfig does the same for LANES
+ * cost vectors at once in a single sweep
+ */
+
+#pragma once
+
+#include <set>
+#include <array>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+#include <tdzdd/DdEval.hpp>
+#include <tdzdd/DdStructure.hpp>
+
+#include "GeoDistributedStorageSystem.hpp"
+
+typedef GeoDistributedStorageSystem::Cost Cost;
+
+namespace tdzdd {
+
+class MinCost: public DdEval<MinCost,Cost> {
+    std::vector<Cost> weights;          ///< cost of each level; weights[0] is not used
+
+public:
+    MinCost(std::vector<Cost> const& weights)
+        : weights(weights) {
+    }
+
+    bool isThreadSafe() const {
+        return true;
+    }
+
+    void evalTerminal(Cost& v, int id) {
+        v = id ? 0 : std::numeric_limits<Cost>::infinity();
+    }
+
+    void evalNode(Cost& v, int level, DdValues<Cost,2> const& values) {
+        Cost c1 = values.get(1) + weights[level];
+        v = (values.get(0) > c1) ? c1 : values.get(0);
+    }
+};
+
+struct MinCostNode {
+    Cost cost;          ///< minimum cost from this node to the 1-terminal
+    bool take;          ///< true if the 1-branch is on the minimum-cost path
+};
+
+class MinCostConfig {
+    DdStructure<2> const& dd;
+    std::vector<Cost> const weights;    ///< cost of each level; weights[0] is not used
+    DataTable<MinCostNode> work;
+
+public:
+    MinCostConfig(DdStructure<2> const& dd, std::vector<Cost> const& weights, bool useMP = false)
+        : dd(dd), weights(weights), work(dd.getDiagram()->numRows()) {
+        NodeTableEntity<2> const& diagram = *dd.getDiagram();
+        int n = dd.topLevel();
+
+        work[0].resize(2);
+        work[0][0] = MinCostNode {std::numeric_limits<Cost>::infinity(), false};
+        work[0][1] = MinCostNode {0, false};
+
+        for (int i = 1; i <= n; ++i) {
+            MyVector<Node<2> > const& node = diagram[i];
+            size_t const m = node.size();
+            work[i].resize(m);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (useMP)
+#endif
+            for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                NodeId f0 = node[j].branch[0];
+                NodeId f1 = node[j].branch[1];
+                Cost c0 = work[f0.row()][f0.col()].cost;
+                Cost c1 = work[f1.row()][f1.col()].cost + weights[i];
+                work[i][j] = (c0 > c1) ? MinCostNode {c1, true} : MinCostNode {c0, false};
+            }
+        }
+    }
+
+    // Get the minimum cost
+    Cost getCost() const {
+        NodeId f = dd.root();
+        return work[f.row()][f.col()].cost;
+    }
+
+    // Get the minimum cost from node f to the 1-terminal
+    Cost getCost(NodeId f) const {
+        return work[f.row()][f.col()].cost;
+    }
+
+    // Check if the 1-branch of node f is on its minimum-cost path
+    bool isTaken(NodeId f) const {
+        return work[f.row()][f.col()].take;
+    }
+
+    // Get the levels taken on the minimum-cost path
+    std::set<int> getConfig() const {
+        std::set<int> config;
+        NodeId f = dd.root();
+
+        while (f.row() != 0) {
+            MinCostNode const& v = work[f.row()][f.col()];
+            if (v.take) config.insert(f.row());
+            f = dd.child(f, v.take);
+        }
+        return config;
+    }
+};
+
+template<int LANES>
+class MultiMinCostConfig {
+    static_assert(0 < LANES && LANES <= 32, "take bits of all lanes must fit in uint32_t");
+
+    typedef std::array<double,LANES> Lanes;
+
+    DdStructure<2> const& dd;
+    int const numLanes;
+    std::vector<Lanes> weights;         ///< cost of each level for each lane; weights[0] is not used
+    DataTable<Lanes> costs;             ///< minimum cost from each node to the 1-terminal for each lane
+    DataTable<uint32_t> takes;          ///< bit l is set if the 1-branch is on the minimum-cost path of lane l
+
+public:
+    /*
+     * weights[l][level] is the cost of level for lane l; lanes without weights are evaluated with zero
+     * cost and ignored
+     */
+    MultiMinCostConfig(DdStructure<2> const& dd, std::vector<std::vector<Cost> > const& laneWeights, bool useMP = false)
+        : dd(dd), numLanes(laneWeights.size()), weights(dd.topLevel() + 1),
+          costs(dd.getDiagram()->numRows()), takes(dd.getDiagram()->numRows()) {
+        assert(numLanes <= LANES);
+        NodeTableEntity<2> const& diagram = *dd.getDiagram();
+        int n = dd.topLevel();
+
+        for (int i = 1; i <= n; ++i) {
+            for (int l = 0; l < LANES; ++l) {
+                weights[i][l] = (l < numLanes) ? double(laneWeights[l][i]) : 0;
+            }
+        }
+
+        costs[0].resize(2);
+        takes[0].resize(2);
+        costs[0][0].fill(std::numeric_limits<double>::infinity());
+        costs[0][1].fill(0);
+
+        for (int i = 1; i <= n; ++i) {
+            MyVector<Node<2> > const& node = diagram[i];
+            size_t const m = node.size();
+            costs[i].resize(m);
+            takes[i].resize(m);
+            double const* w = weights[i].data();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (useMP)
+#endif
+            for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                NodeId f0 = node[j].branch[0];
+                NodeId f1 = node[j].branch[1];
+                double const* c0 = costs[f0.row()][f0.col()].data();
+                double const* c1 = costs[f1.row()][f1.col()].data();
+                double* c = costs[i][j].data();
+                uint32_t take = 0;
+
+#pragma omp simd reduction(|:take)
+                for (int l = 0; l < LANES; ++l) {
+                    double t1 = c1[l] + w[l];
+                    bool b = c0[l] > t1;
+                    c[l] = b ? t1 : c0[l];
+                    take |= uint32_t(b) << l;
+                }
+                takes[i][j] = take;
+            }
+        }
+    }
+
+    // Get number of lanes evaluated
+    int size() const {
+        return numLanes;
+    }
+
+    // Get the minimum cost of lane l
+    Cost getCost(int l) const {
+        assert(0 <= l && l < numLanes);
+        NodeId f = dd.root();
+        return costs[f.row()][f.col()][l];
+    }
+
+    // Get the levels taken on the minimum-cost path of lane l
+    std::set<int> getConfig(int l) const {
+        assert(0 <= l && l < numLanes);
+        std::set<int> config;
+        NodeId f = dd.root();
+
+        while (f.row() != 0) {
+            bool take = (takes[f.row()][f.col()] >> l) & 1;
+            if (take) config.insert(f.row());
+            f = dd.child(f, take);
+        }
+        return config;
+    }
+};
+
+} // namespace tdzdd
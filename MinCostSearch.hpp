@@ -0,0 +1,289 @@
+/*
+ * A top-down dynamic program for getting an optimal configuration/placement directly from a DdSpec
+ * without building the ZDD
+ *
+ * States are merged per level as in DdBuilder, but only the best partial cost of each merged state
+ * and the last step of its cheapest path are kept, and a level is released as soon as it has been
+ * expanded. Equal states are merged while they are added, so that states take memory only while they
+ * wait, and every merged state leaves one word behind for tracing the optimal path back
+ */
+
+#pragma once
+
+#include <set>
+#include <limits>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+#include <tdzdd/DdSpec.hpp>
+#include <tdzdd/util/MessageHandler.hpp>
+#include <tdzdd/util/MyHashTable.hpp>
+
+namespace tdzdd {
+
+template<typename SPEC, typename C = double>
+class MinCostSearch {
+    typedef size_t Word;
+    static constexpr size_t NIL = size_t(-1);
+
+    // A step of a path packed in a word: the row of a merged state at a level and the branch taken from it
+    // Level 0 marks the start of the path; levels take LEVEL_BITS bits and rows the rest but one
+    typedef uint64_t Step;
+    static constexpr int LEVEL_BITS = 26;
+
+    static Step makeStep(int level, size_t row, int b) {
+        return (uint64_t(row) << (LEVEL_BITS + 1)) | (uint64_t(level) << 1) | b;
+    }
+
+    static int stepLevel(Step t) {
+        return int(t >> 1) & ((1 << LEVEL_BITS) - 1);
+    }
+
+    static size_t stepRow(Step t) {
+        return t >> (LEVEL_BITS + 1);
+    }
+
+    static int stepBranch(Step t) {
+        return int(t & 1);
+    }
+
+    // Buffers of released buckets, reused by later ones instead of faulting in fresh memory
+    struct Spare {
+        std::vector<Word> rows;
+        std::vector<C> costs;
+        std::vector<Step> steps;
+        std::vector<size_t> table;
+    };
+
+    // Keep the larger of two buffers as a spare
+    template<typename T>
+    static void recycle(std::vector<T>& v, std::vector<T>& spare) {
+        if (v.capacity() > spare.capacity()) v.swap(spare);
+    }
+
+    // States waiting at one level, merged by state equality as they arrive, with the cost and the last
+    // step of the cheapest path to each
+    class Bucket {
+        static constexpr size_t MIN_MERGE = 4096;   ///< smallest unmerged tail worth merging
+
+        SPEC& spec;
+        Spare& spare;
+        int const level;
+        int const stateWords;
+        std::vector<Word> rows;
+        std::vector<C> costs;
+        std::vector<Step> steps;
+        std::vector<size_t> table;      ///< row index of each slot, NIL if empty
+        size_t merged;                  ///< number of leading rows without duplicates
+
+        // Find the slot of state s, or the empty slot where it goes
+        size_t& slot(void const* s) {
+            size_t h = spec.hash_code(s, level) % table.size();
+            for (; table[h] != NIL; h = (h + 1 == table.size()) ? 0 : h + 1) {
+                if (spec.equal_to(state(table[h]), s, level)) break;
+            }
+            return table[h];
+        }
+
+        // Merge the rows added since the last merge into the leading ones, keeping the cheaper path of each state
+        void merge() {
+            size_t const m = costs.size();
+            if (table.size() < m * 2) {
+                if (table.empty()) table.swap(spare.table);
+                table.assign(MyHashConstant::primeSize(m * 2), NIL);
+                for (size_t k = 0; k < merged; ++k) {
+                    slot(state(k)) = k;
+                }
+            }
+
+            size_t w = merged;
+            for (size_t k = merged; k < m; ++k) {
+                size_t& t = slot(state(k));
+                if (t != NIL) {
+                    if (costs[k] < costs[t]) {
+                        costs[t] = costs[k];
+                        steps[t] = steps[k];
+                    }
+                    spec.destruct(state(k));
+                    continue;
+                }
+
+                if (w != k) {
+                    spec.get_copy(state(w), state(k));
+                    spec.destruct(state(k));
+                    costs[w] = costs[k];
+                    steps[w] = steps[k];
+                }
+                t = w++;
+            }
+
+            rows.resize(w * stateWords);
+            costs.resize(w);
+            steps.resize(w);
+            merged = w;
+        }
+
+    public:
+        Bucket(SPEC& spec, Spare& spare, int level, int stateWords)
+            : spec(spec), spare(spare), level(level), stateWords(stateWords), merged(0) {
+        }
+
+        ~Bucket() {
+            for (size_t k = 0; k < costs.size(); ++k) {
+                spec.destruct(state(k));
+            }
+            recycle(rows, spare.rows);
+            recycle(costs, spare.costs);
+            recycle(steps, spare.steps);
+        }
+
+        void* state(size_t k) {
+            return rows.data() + k * stateWords;
+        }
+
+        C cost(size_t k) const {
+            return costs[k];
+        }
+
+        // Add state s reached by step at cost, merging duplicates once they may take as much room as the
+        // distinct states
+        void add(void const* s, C cost, Step step) {
+            size_t k = costs.size();
+            if (k == 0 && rows.capacity() == 0) {
+                rows.swap(spare.rows);
+                costs.swap(spare.costs);
+                steps.swap(spare.steps);
+                rows.clear();
+                costs.clear();
+                steps.clear();
+            }
+            rows.resize((k + 1) * stateWords);
+            spec.get_copy(state(k), s);
+            costs.push_back(cost);
+            steps.push_back(step);
+
+            if (k + 1 - merged >= std::max(merged, MIN_MERGE)) merge();
+        }
+
+        // Merge the remaining duplicates and release the hash table and the room they took
+        void close() {
+            merge();
+            recycle(table, spare.table);
+            std::vector<size_t>().swap(table);
+            if (costs.capacity() > costs.size() * 2) {
+                std::vector<Word>(rows).swap(rows);
+                std::vector<C>(costs).swap(costs);
+            }
+        }
+
+        // Copy the last steps of the merged states out, in the order of the states
+        void releaseSteps(std::vector<Step>& v) {
+            v.assign(steps.begin(), steps.end());
+        }
+
+        size_t size() const {
+            return costs.size();
+        }
+    };
+
+    SPEC spec;
+    std::vector<C> const weights;       ///< cost of each level; weights[0] is not used
+    Spare spare;
+    C bestCost;
+    std::set<int> bestConfig;           ///< levels taken on the minimum-cost path
+    size_t maxWidth;
+
+public:
+    /*
+     * weights[level] is the cost of taking the 1-branch at level
+     */
+    MinCostSearch(SPEC const& spec, std::vector<C> const& weights)
+        : spec(spec), weights(weights), bestCost(std::numeric_limits<C>::infinity()), maxWidth(0) {
+        int const stateWords = (this->spec.datasize() + sizeof(Word) - 1) / sizeof(Word);
+        std::vector<Word> tmp(std::max(stateWords, 1));
+        void* const s = tmp.data();
+
+        MessageHandler mh;
+        mh.begin("MinCostSearch");
+
+        int n = this->spec.get_root(s);
+        if (n < 0) bestCost = 0;
+        if (n <= 0) {
+            this->spec.destruct(s);
+            mh << " ...";
+            mh.end(maxWidth);
+            return;
+        }
+
+        // The last step of the cheapest path to each merged state of the expanded levels
+        std::vector<std::vector<Step> > history(n + 1);
+        Step bestStep = makeStep(0, 0, 0);
+
+        std::vector<std::unique_ptr<Bucket> > buckets(n + 1);
+        for (int i = 1; i <= n; ++i) buckets[i].reset(new Bucket(this->spec, spare, i, std::max(stateWords, 1)));
+        buckets[n]->add(s, 0, makeStep(0, 0, 0));
+        this->spec.destruct(s);
+
+        mh.setSteps(n);
+        for (int i = n; i > 0; --i) {
+            Bucket& bucket = *buckets[i];
+            bucket.close();
+            maxWidth = std::max(maxWidth, bucket.size());
+
+            for (size_t k = 0; k < bucket.size(); ++k) {
+                for (int b = 0; b < SPEC::ARITY; ++b) {
+                    this->spec.get_copy(s, bucket.state(k));
+                    int ii = this->spec.get_child(s, i, b);
+                    C cost = b ? bucket.cost(k) + weights[i] : bucket.cost(k);
+
+                    if (ii != 0 && (ii > 0 || cost < bestCost)) {
+                        if (ii < 0) {
+                            bestCost = cost;
+                            bestStep = makeStep(i, k, b);
+                        }
+                        else {
+                            buckets[ii]->add(s, cost, makeStep(i, k, b));
+                        }
+                    }
+                    this->spec.destruct(s);
+                }
+            }
+
+            bucket.releaseSteps(history[i]);
+            buckets[i].reset();
+            this->spec.destructLevel(i);
+            mh.step();
+        }
+        spare = Spare();
+
+        for (Step t = bestStep; stepLevel(t) > 0; t = history[stepLevel(t)][stepRow(t)]) {
+            if (stepBranch(t)) bestConfig.insert(stepLevel(t));
+        }
+
+        mh.end(maxWidth);
+    }
+
+    // Check if a feasible configuration exists
+    bool found() const {
+        return bestCost != std::numeric_limits<C>::infinity();
+    }
+
+    // Get the minimum cost
+    C getCost() const {
+        return bestCost;
+    }
+
+    // Get the levels taken on the minimum-cost path
+    std::set<int> getConfig() const {
+        return bestConfig;
+    }
+
+    // Get the maximum number of merged states expanded at one level
+    size_t getMaxWidth() const {
+        return maxWidth;
+    }
+};
+
+} // namespace tdzdd
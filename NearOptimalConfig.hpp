@@ -0,0 +1,100 @@
+/*
+ * An enumerator for getting every configuration/placement whose cost is within (1+eps) of the
+ * minimum cost directly from the ZDD
+ *
+ * The minimum cost from each node to the 1-terminal is a lower bound of every completion, so a
+ * depth-first search that drops each branch whose prefix cost plus lower bound exceeds the bound
+ * reaches only near-optimal placements, in no particular order of cost
+ */
+
+#pragma once
+
+#include <set>
+#include <cmath>
+#include <vector>
+#include <limits>
+
+#include <tdzdd/DdStructure.hpp>
+
+#include "MinCostConfig.hpp"
+
+namespace tdzdd {
+
+class NearOptimalConfig {
+    struct Frame {
+        NodeId f;
+        Cost cost;          ///< cost of the path from the root to f
+        int branch;         ///< next branch of f to search
+    };
+
+    DdStructure<2> const& dd;
+    std::vector<Cost> const weights;    ///< cost of each level; weights[0] is not used
+    MinCostConfig optConfig;
+    Cost bound;
+    std::vector<Frame> stack;
+    Cost currCost;
+    std::set<int> currConfig;
+
+public:
+    NearOptimalConfig(DdStructure<2> const& dd, std::vector<Cost> const& weights, double eps, bool useMP = false)
+        : dd(dd), weights(weights), optConfig(dd, weights, useMP), currCost(std::numeric_limits<Cost>::infinity()) {
+        Cost opt = optConfig.getCost();
+        if (opt == std::numeric_limits<Cost>::infinity()) return;
+
+        // Allow for rounding errors in summing up costs in different orders
+        bound = opt + eps * std::fabs(opt);
+        bound += std::fabs(bound) * std::numeric_limits<Cost>::epsilon() * (dd.topLevel() + 1);
+
+        if (dd.root().row() == 0) {
+            currCost = 0;
+            return;
+        }
+        stack.push_back(Frame {dd.root(), 0, 0});
+        next();
+    }
+
+    // Check if there is a current placement
+    bool found() const {
+        return currCost != std::numeric_limits<Cost>::infinity();
+    }
+
+    // Move to the next placement within the bound
+    void next() {
+        while (!stack.empty()) {
+            Frame& fr = stack.back();
+            if (fr.branch == 2) {
+                stack.pop_back();
+                continue;
+            }
+
+            int b = fr.branch++;
+            NodeId g = dd.child(fr.f, b);
+            Cost c = b ? fr.cost + weights[fr.f.row()] : fr.cost;
+            if (c + optConfig.getCost(g) > bound) continue;
+
+            if (g.row() == 0) {
+                currCost = c;
+                currConfig.clear();
+                for (size_t k = 0; k < stack.size(); ++k) {
+                    if (stack[k].branch == 2) currConfig.insert(stack[k].f.row());
+                }
+                return;
+            }
+            stack.push_back(Frame {g, c, 0});
+        }
+        currCost = std::numeric_limits<Cost>::infinity();
+        currConfig.clear();
+    }
+
+    // Get the cost of the current placement
+    Cost getCost() const {
+        return currCost;
+    }
+
+    // Get the levels taken on the current placement
+    std::set<int> getConfig() const {
+        return currConfig;
+    }
+};
+
+} // namespace tdzdd
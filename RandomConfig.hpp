@@ -0,0 +1,93 @@
+/*
+ * A sampler for drawing random configurations/placements directly from the ZDD
+ *
+ * Each placement is drawn with probability proportional to exp(-beta * cost), which is uniform over
+ * all placements if beta = 0. The partition function of each node is computed once bottom-up in log
+ * space, after which a draw walks from the root taking the 1-branch with its conditional probability
+ */
+
+#pragma once
+
+#include <set>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <random>
+
+#include <tdzdd/DdStructure.hpp>
+
+#include "MinCostConfig.hpp"
+
+namespace tdzdd {
+
+class RandomConfig {
+    DdStructure<2> const& dd;
+    std::vector<Cost> const weights;    ///< cost of each level; weights[0] is not used
+    DataTable<double> prob;             ///< probability of taking the 1-branch at each node
+
+    static Cost logAddExp(Cost a, Cost b) {
+        if (a < b) std::swap(a, b);
+        if (b == -std::numeric_limits<Cost>::infinity()) return a;
+        return a + std::log1p(std::exp(b - a));
+    }
+
+public:
+    RandomConfig(DdStructure<2> const& dd, std::vector<Cost> const& weights, double beta = 0, bool useMP = false)
+        : dd(dd), weights(weights), prob(dd.getDiagram()->numRows()) {
+        NodeTableEntity<2> const& diagram = *dd.getDiagram();
+        int n = dd.topLevel();
+
+        // Logarithm of the sum of exp(-beta * cost) over all paths from each node to the 1-terminal
+        DataTable<Cost> logZ(diagram.numRows());
+        logZ[0].resize(2);
+        logZ[0][0] = -std::numeric_limits<Cost>::infinity();
+        logZ[0][1] = 0;
+        prob[0].resize(2);
+
+        for (int i = 1; i <= n; ++i) {
+            MyVector<Node<2> > const& node = diagram[i];
+            size_t const m = node.size();
+            logZ[i].resize(m);
+            prob[i].resize(m);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (useMP)
+#endif
+            for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                NodeId f0 = node[j].branch[0];
+                NodeId f1 = node[j].branch[1];
+                Cost z0 = logZ[f0.row()][f0.col()];
+                Cost z1 = logZ[f1.row()][f1.col()] - beta * weights[i];
+                Cost z = logAddExp(z0, z1);
+                logZ[i][j] = z;
+                prob[i][j] = (z1 == -std::numeric_limits<Cost>::infinity()) ? 0 : double(std::exp(z1 - z));
+            }
+        }
+    }
+
+    // Check if there is a placement to draw
+    bool found() const {
+        return dd.root() != NodeId(0);
+    }
+
+    // Draw a placement into config and get its cost
+    template<typename RNG>
+    Cost draw(RNG& rng, std::set<int>& config) const {
+        std::uniform_real_distribution<double> uniform(0, 1);
+        Cost cost = 0;
+        config.clear();
+
+        NodeId f = dd.root();
+        while (f.row() != 0) {
+            bool take = uniform(rng) < prob[f.row()][f.col()];
+            if (take) {
+                config.insert(f.row());
+                cost += weights[f.row()];
+            }
+            f = dd.child(f, take);
+        }
+        return cost;
+    }
+};
+
+} // namespace tdzdd
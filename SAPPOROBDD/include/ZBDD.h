@@ -123,6 +123,9 @@ extern ZBDD ZBDD_LCM_M(char *, int);
 inline ZBDD ZBDD_ID(bddword zbdd)
   { ZBDD h; h._zbdd = zbdd; return h; }
 
+inline ZBDD ZBDD_Node(int v, const ZBDD& f0, const ZBDD& f1)
+  { return ZBDD_ID(bddmakenodez(v, f0.GetID(), f1.GetID())); }
+
 inline ZBDD BDD_CacheZBDD(char op, bddword fx, bddword gx)
   { return ZBDD_ID(bddcopy(bddrcache(op, fx, gx))); }
 
@@ -124,6 +124,7 @@ extern int    bddimportz B_ARG((FILE* strm, bddp* p, int lim));
 extern char  *bddcardmp16 B_ARG((bddp f, char *s));
 extern int    bddisbdd B_ARG((bddp f));
 extern int    bddiszbdd B_ARG((bddp f));
+extern bddp   bddmakenodez B_ARG((bddvar v, bddp f0, bddp f1));
 
 /************** SeqBDD operations *************/
 extern bddp   bddpush B_ARG((bddp f, bddvar v));
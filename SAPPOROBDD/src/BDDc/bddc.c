@@ -1403,6 +1403,32 @@ bddp f;
   return (B_NEG(B_GET_BDDP(fp->f0)) ? 1 : 0);
 }
 
+bddp    bddmakenodez(v, f0, f1)
+bddvar  v;
+bddp    f0, f1;
+/* Returns bddnull if not enough memory */
+{
+  struct B_NodeTable *fp;
+  bddp h;
+
+  /* Check operands */
+  if(v > VarUsed || v == 0) err("bddmakenodez: Invalid VarID", v);
+  if(f0 == bddnull || f1 == bddnull) return bddnull;
+  if(Var[bddtop(f0)].lev >= Var[v].lev) err("bddmakenodez: Invalid 0-edge", f0);
+  if(Var[bddtop(f1)].lev >= Var[v].lev) err("bddmakenodez: Invalid 1-edge", f1);
+
+  /* The new node takes over a reference of each child */
+  if(!B_CST(f0)) { fp = B_NP(f0); B_RFC_INC_NP(fp); }
+  if(!B_CST(f1)) { fp = B_NP(f1); B_RFC_INC_NP(fp); }
+  h = getzbddp(v, f0, f1);
+  if(h == bddnull)
+  {
+    bddfree(f0);
+    bddfree(f1);
+  }
+  return h;
+}
+
 bddp    bddpush(f, v)
 bddp    f;
 bddvar 	v;
@@ -30,6 +30,7 @@
 #include <ostream>
 #include <set>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "DdEval.hpp"
@@ -45,6 +46,7 @@
 #include "util/MessageHandler.hpp"
 #include "util/MyHashTable.hpp"
 #include "util/MyVector.hpp"
+#include "util/WorkStealing.hpp"
 
 namespace tdzdd {
 
@@ -104,6 +106,8 @@ public:
     template<typename SPEC>
     DdStructure(DdSpecBase<SPEC,ARITY> const& spec, bool useMP = false) :
             useMP(useMP) {
+        if (!spillDir().empty()) constructSpill_(spec.entity());
+        else
 #ifdef _OPENMP
         if (useMP) constructMP_(spec.entity());
         else
@@ -133,6 +137,28 @@ private:
         mh.end(size());
     }
 
+    template<typename SPEC>
+    void constructSpill_(SPEC const& spec) {
+        MessageHandler mh;
+        mh.begin(typenameof(spec));
+        DdBuilderSpill<SPEC> zc(spec, diagram, spillDir(), spillBuffer());
+        int n = zc.initialize(root_);
+
+        if (n > 0) {
+            mh.setSteps(n);
+            for (int i = n; i > 0; --i) {
+                zc.construct(i);
+                mh.step();
+            }
+            zc.finish();
+        }
+        else {
+            mh << " ...";
+        }
+
+        mh.end(size());
+    }
+
     template<typename SPEC>
     void constructMP_(SPEC const& spec) {
         MessageHandler mh;
@@ -235,6 +261,30 @@ public:
         return old;
     }
 
+    /**
+     * Enables or disables spilling data to a scratch file in construction.
+     * It overrides multiple processor construction.
+     * @param dir directory of the scratch file, or empty for disabling.
+     * @param bufferSize bytes of nodes and SpecNodes kept in memory.
+     */
+    static void useSpillBuilder(std::string const& dir,
+            size_t bufferSize = size_t(1) << 30) {
+        spillDir() = dir;
+        spillBuffer() = bufferSize;
+    }
+
+private:
+    static std::string& spillDir() {
+        static std::string dir;
+        return dir;
+    }
+
+    static size_t& spillBuffer() {
+        static size_t size = 0;
+        return size;
+    }
+
+public:
     /**
      * Gets the root node.
      * @return root node ID.
@@ -472,6 +522,7 @@ public:
 #ifdef _OPENMP
         int threads = useMP ? omp_get_max_threads() : 0;
         MyVector<S> evals(threads, eval);
+        WorkStealingLoop loop(typenameof(eval), threads);
 #endif
         eval.initialize(n);
 #ifdef _OPENMP
@@ -504,8 +555,7 @@ public:
             {
                 int k = omp_get_thread_num();
 
-#pragma omp for schedule(static)
-                for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                loop.run(i, m, [&](intmax_t j) {
                     DdValues<T,ARITY> values;
                     for (int b = 0; b < ARITY; ++b) {
                         NodeId f = node[j].branch[b];
@@ -513,7 +563,7 @@ public:
                         values.setLevel(b, f.row());
                     }
                     evals[k].evalNode(work[i][j], i, values);
-                }
+                });
             }
             else
 #endif
@@ -24,10 +24,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
+#include <exception>
 #include <ostream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -42,6 +47,8 @@
 #include "../util/MyHashTable.hpp"
 #include "../util/MyList.hpp"
 #include "../util/MyVector.hpp"
+#include "../util/SpillFile.hpp"
+#include "../util/WorkStealing.hpp"
 
 namespace tdzdd {
 
@@ -300,7 +307,7 @@ public:
 //#endif
         }
 
-        output[i].resize(m);
+        output.resizeRow(i, m);
         Node<AR>* const outi = output[i].data();
         size_t jj = j0;
         SpecNode* pp = snodeTable[i - 1].alloc_front(specNodeSize);
@@ -407,6 +414,7 @@ class DdBuilderMP: DdBuilderMPBase {//TODO oneStorage
     DdSweeper<AR> sweeper;
 
     MyVector<MyVector<MyVector<MyList<SpecNode> > > > snodeTables;
+    WorkStealingLoop loop;
 
 #ifdef DEBUG
     ElapsedTimeCounter etcP1, etcP2, etcS1;
@@ -435,7 +443,8 @@ public:
             specNodeSize(getSpecNodeSize(s.datasize())),
             output(output.privateEntity()),
             sweeper(this->output),
-            snodeTables(threads) {
+            snodeTables(threads),
+            loop(typenameof(s), threads) {
         if (n >= 1) init(n);
 #ifdef DEBUG
         MessageHandler mh;
@@ -498,6 +507,7 @@ public:
         MyVector<size_t> nodeColumn(tasks);
         int lowestChild = i - 1;
         size_t deadCount = 0;
+        std::exception_ptr error; // rethrown outside the parallel region
 
 #ifdef DEBUG
         etcP1.start();
@@ -522,15 +532,12 @@ public:
             UniqTable uniq(hasher, hasher);
             int lc = lowestChild;
 
-#ifdef _OPENMP
-#pragma omp for schedule(dynamic)
-#endif
-            for (int x = 0; x < tasks; ++x) {
+            loop.run(i, tasks, [&](intmax_t x) {
                 size_t m = 0;
                 for (int y = 0; y < threads; ++y) {
                     m += snodeTables[y][x][i].size();
                 }
-                if (m == 0) continue;
+                if (m == 0) return;
 
                 uniq.initialize(m * 2);
                 size_t j = 0;
@@ -572,7 +579,7 @@ public:
 //#endif
 //                mh << "table_size[" << i << "][" << x << "] = " << uniq.tableSize() << "\n";
 //#endif
-            }
+            }, true);
 
 #ifdef _OPENMP
 #pragma omp single
@@ -589,18 +596,21 @@ public:
                     m += j;
                 }
 
-                output.initRow(i, m);
+                try {
+                    output.initRow(i, m);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
 #ifdef DEBUG
                 etcS1.stop();
                 etcP2.start();
 #endif
             }
 
-#ifdef _OPENMP
-#pragma omp for schedule(dynamic)
-#endif
-            for (int x = 0; x < tasks; ++x) {
-                if (nodeColumn[x] < 0) continue; // -1 for skip
+            loop.run(i, tasks, [&](intmax_t x) {
+                if (error) return;
+                if (nodeColumn[x] < 0) return; // -1 for skip
                 size_t j0 = nodeColumn[x] - 1;   // code(p) >= 1
 
                 for (int y = 0; y < threads; ++y) {
@@ -654,7 +664,7 @@ public:
                         if (allZero) ++deadCount;
                     }
                 }
-            }
+            }, true);
 
             spec.destructLevel(i);
 
@@ -664,6 +674,7 @@ public:
             if (lc < lowestChild) lowestChild = lc;
         }
 
+        if (error) std::rethrow_exception(error);
         sweeper.update(i, lowestChild, deadCount);
 #ifdef DEBUG
         etcP2.stop();
@@ -671,6 +682,404 @@ public:
     }
 };
 
+/**
+ * Breadth-first DD builder that keeps its working memory within a buffer
+ * by spilling data to a scratch file.
+ * When the buffer is full, the nodes of finished levels and then the
+ * SpecNodes of the levels farthest from the current one are written out
+ * in sequential batches; the SpecNodes are read back when their level is
+ * built.
+ * Edges into nodes that have been written out are kept in a fixup log.
+ * At the end, the levels are read back from the bottom with their edges
+ * completed by the log, while equivalent nodes are merged and nodes
+ * equivalent to the 0-terminal are removed, so that the unreduced
+ * diagram never has to be in memory as a whole.
+ * merge_states(void*, void*) is not supported, and states must be
+ * copyable bit by bit like those of PodArrayDdSpec.
+ */
+template<typename S>
+class DdBuilderSpill: DdBuilderMPBase {
+    typedef S Spec;
+    typedef MyHashTable<SpecNode*,Hasher<Spec>,Hasher<Spec> > UniqTable;
+    static int const AR = Spec::ARITY;
+    static size_t const BATCH_BYTES = size_t(4) << 20; ///< unit of writing
+
+    /*
+     * Edge whose child node has been found after its parent node has been
+     * written out.
+     */
+    struct Fixup {
+        NodeBranchId edge;
+        NodeId child;
+    };
+
+    Spec spec;
+    int const specNodeSize;
+    size_t const nodeBytes;     ///< bytes of a SpecNode
+    NodeTableEntity<AR>& output;
+    size_t const bufferSize;
+    SpillFile file;
+
+    MyVector<MyList<SpecNode> > snodeTable;
+    MyVector<std::vector<SpillFile::Extent> > snodeExtents;
+    MyVector<SpillFile::Extent> rowExtent;
+    MyVector<MyVector<Fixup> > fixups;
+    MyVector<std::vector<SpillFile::Extent> > fixupExtents;
+    MyVector<int> parentLevel;  ///< highest level of the parents of each level
+    MyVector<SpecNode> batch;
+
+    NodeId* rootPtr;
+    int topLevel;
+    int spilledRow;             ///< rows at this level and above are on disk
+    size_t snodeBytes;          ///< bytes of SpecNodes in memory
+    size_t rowBytes;            ///< bytes of nodes in memory
+    size_t fixupBytes;          ///< bytes of fixups in memory
+
+    /*
+     * Header of a SpecNode: the parent node and the branch index until it
+     * gets a column at its own level.
+     */
+    static NodeId& parent(SpecNode* p) {
+        return *reinterpret_cast<NodeId*>(&p[0].code);
+    }
+
+    void init(int n) {
+        snodeTable.resize(n + 1);
+        snodeExtents.resize(n + 1);
+        rowExtent.resize(n + 1);
+        fixups.resize(n + 1);
+        fixupExtents.resize(n + 1);
+        parentLevel.resize(n + 1);
+        for (int i = 0; i <= n; ++i) {
+            parentLevel[i] = 0;
+        }
+        parentLevel[n] = n + 1; // the root
+        if (n >= output.numRows()) output.setNumRows(n + 1);
+        topLevel = n;
+        spilledRow = n + 1;
+    }
+
+    void link(NodeId f, int b, NodeId child) {
+        if (f.row() == 0) {
+            *rootPtr = child;
+        }
+        else if (f.row() < spilledRow) {
+            output[f.row()][f.col()].branch[b] = child;
+        }
+        else {
+            Fixup x;
+            x.edge = NodeBranchId(f.row(), f.col(), b);
+            x.child = child;
+            fixups[f.row()].push_back(x);
+            fixupBytes += sizeof(Fixup);
+            if (fixupBytes >= BATCH_BYTES) spillFixups();
+        }
+    }
+
+    void spillFixups() {
+        for (int i = 1; i <= topLevel; ++i) {
+            if (fixups[i].empty()) continue;
+            fixupExtents[i].push_back(
+                    file.append(fixups[i].data(),
+                                fixups[i].size() * sizeof(Fixup)));
+            fixups[i].clear();
+        }
+        fixupBytes = 0;
+    }
+
+    void spillRow(int i) {
+        size_t const m = output[i].size();
+        rowExtent[i] = file.append(output[i].data(), m * sizeof(Node<AR>));
+        output[i].clear();
+        rowBytes -= m * sizeof(Node<AR>);
+    }
+
+    void spillSpecNodes(int i) {
+        MyList<SpecNode>& snodes = snodeTable[i];
+        size_t const k = batch.size() / specNodeSize;
+        size_t j = 0;
+
+        snodeBytes -= snodes.size() * nodeBytes;
+        for (; !snodes.empty(); snodes.pop_front()) {
+            std::memcpy(batch.data() + j * specNodeSize, snodes.front(),
+                        nodeBytes);
+            if (++j == k) {
+                snodeExtents[i].push_back(file.append(batch.data(), j * nodeBytes));
+                j = 0;
+            }
+        }
+        if (j > 0) {
+            snodeExtents[i].push_back(file.append(batch.data(), j * nodeBytes));
+        }
+    }
+
+    /*
+     * Writes out data until the memory usage gets down to half the buffer,
+     * while building level i.
+     */
+    void spill(int i) {
+        while (snodeBytes + rowBytes > bufferSize / 2) {
+            if (spilledRow - 1 > i) {
+                spillRow(--spilledRow);
+                continue;
+            }
+
+            int ii = 1;
+            while (ii < i && snodeTable[ii].empty()) {
+                ++ii;
+            }
+            if (ii >= i) break;
+            spillSpecNodes(ii);
+        }
+    }
+
+    void loadSpecNodes(int i) {
+        std::vector<SpillFile::Extent>& extents = snodeExtents[i];
+        MyList<SpecNode>& snodes = snodeTable[i];
+
+        for (size_t t = 0; t < extents.size(); ++t) {
+            file.read(extents[t], batch.data());
+            size_t const k = extents[t].size / nodeBytes;
+            for (size_t j = 0; j < k; ++j) {
+                std::memcpy(snodes.alloc_front(specNodeSize),
+                            batch.data() + j * specNodeSize, nodeBytes);
+            }
+            snodeBytes += k * nodeBytes;
+            file.release(extents[t]);
+        }
+        std::vector<SpillFile::Extent>().swap(extents);
+    }
+
+    void loadRow(int i, MyVector<Node<AR> >& row) {
+        if (i >= spilledRow) {
+            row.resize(rowExtent[i].size / sizeof(Node<AR>));
+            file.read(rowExtent[i], row.data());
+            file.release(rowExtent[i]);
+        }
+        else {
+            row = output[i];
+        }
+
+        MyVector<Fixup> buf;
+        std::vector<SpillFile::Extent>& extents = fixupExtents[i];
+        for (size_t t = 0; t <= extents.size(); ++t) {
+            if (t < extents.size()) {
+                buf.resize(extents[t].size / sizeof(Fixup));
+                file.read(extents[t], buf.data());
+                file.release(extents[t]);
+            }
+            MyVector<Fixup> const& x = (t < extents.size()) ? buf : fixups[i];
+            for (size_t k = 0; k < x.size(); ++k) {
+                row[x[k].edge.col].branch[x[k].edge.val] = x[k].child;
+            }
+        }
+        std::vector<SpillFile::Extent>().swap(extents);
+        fixups[i].clear();
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param spec DD spec.
+     * @param output result storage.
+     * @param dir directory of the scratch file.
+     * @param bufferSize bytes of nodes and SpecNodes kept in memory.
+     * @param n the number of levels.
+     */
+    DdBuilderSpill(Spec const& spec, NodeTableHandler<AR>& output,
+            std::string const& dir, size_t bufferSize, int n = 0) :
+            spec(spec),
+            specNodeSize(getSpecNodeSize(spec.datasize())),
+            nodeBytes(specNodeSize * sizeof(SpecNode)),
+            output(output.privateEntity()),
+            bufferSize(std::max(bufferSize, 4 * BATCH_BYTES)),
+            file(dir),
+            batch(std::max(BATCH_BYTES / nodeBytes, size_t(1)) * specNodeSize),
+            rootPtr(0),
+            topLevel(0),
+            spilledRow(1),
+            snodeBytes(0),
+            rowBytes(0),
+            fixupBytes(0) {
+        if (n >= 1) init(n);
+    }
+
+    /**
+     * Initializes the builder.
+     * @param root result storage.
+     */
+    int initialize(NodeId& root) {
+        rootPtr = &root;
+        MyVector<char> tmp(spec.datasize());
+        void* const tmpState = tmp.data();
+        int n = spec.get_root(tmpState);
+
+        if (n <= 0) {
+            root = n ? 1 : 0;
+            n = 0;
+        }
+        else {
+            init(n);
+            SpecNode* p = snodeTable[n].alloc_front(specNodeSize);
+            spec.get_copy(state(p), tmpState);
+            parent(p) = 0;
+            code(p) = 0;
+            snodeBytes += nodeBytes;
+        }
+
+        spec.destruct(tmpState);
+        return n;
+    }
+
+    /**
+     * Builds one level.
+     * @param i level.
+     */
+    void construct(int i) {
+        assert(0 < i && size_t(i) < snodeTable.size());
+
+        loadSpecNodes(i);
+        MyList<SpecNode>& snodes = snodeTable[i];
+        size_t m = 0;
+
+        {
+            Hasher<Spec> hasher(spec, i);
+            UniqTable uniq(snodes.size() * 2, hasher, hasher);
+
+            for (MyList<SpecNode>::iterator t = snodes.begin();
+                    t != snodes.end(); ++t) {
+                SpecNode* p = *t;
+                SpecNode* p0 = uniq.add(p);
+                int b = code(p);
+
+                if (p0 == p) {
+                    code(p) = m++; // code(p) >= 0
+                }
+                else {
+                    code(p) = -1;
+                }
+                link(parent(p), b, NodeId(i, code(p0)));
+            }
+        }
+
+        output.initRow(i, m);
+        rowBytes += m * sizeof(Node<AR>);
+        MyVector<char> tmp(spec.datasize());
+        void* const tmpState = tmp.data();
+
+        for (; !snodes.empty(); snodes.pop_front()) {
+            SpecNode* p = snodes.front();
+            snodeBytes -= nodeBytes;
+
+            if (code(p) < 0) {
+                spec.destruct(state(p));
+                continue;
+            }
+
+            size_t const j = code(p);
+            void* s = tmpState;
+
+            for (int b = 0; b < AR; ++b) {
+                if (b < AR - 1) {
+                    spec.get_copy(s, state(p));
+                }
+                else {
+                    s = state(p);
+                }
+
+                int ii = spec.get_child(s, i, b);
+                output[i][j].branch[b] = (ii < 0) ? 1 : 0;
+
+                if (ii > 0) {
+                    assert(ii <= i - 1);
+                    SpecNode* pp = snodeTable[ii].alloc_front(specNodeSize);
+                    spec.get_copy(state(pp), s);
+                    parent(pp) = NodeId(i, j);
+                    code(pp) = b;
+                    snodeBytes += nodeBytes;
+                    if (parentLevel[ii] == 0) parentLevel[ii] = i;
+                }
+
+                spec.destruct(s);
+            }
+
+            if (snodeBytes + rowBytes > bufferSize) spill(i);
+        }
+
+        spec.destructLevel(i);
+    }
+
+    /**
+     * Reads back the levels from the bottom, merging equivalent nodes.
+     * Only the merged diagram and the new node IDs of the levels that
+     * are still referred to from higher levels are kept in memory.
+     */
+    void finish() {
+        MessageHandler mh;
+        mh.begin("merging") << " <" << (file.size() >> 20) << "MB spilled> ...";
+
+        MyVector<MyVector<NodeId> > newId(topLevel + 1);
+        newId[0].resize(2);
+        newId[0][0] = 0;
+        newId[0][1] = 1;
+
+        MyVector<MyVector<int> > lastUse(topLevel + 2);
+        for (int i = 1; i <= topLevel; ++i) {
+            lastUse[parentLevel[i]].push_back(i);
+        }
+
+        MyVector<Node<AR> > row;
+        for (int i = 1; i <= topLevel; ++i) {
+            loadRow(i, row);
+            size_t const m = row.size();
+            newId[i].resize(m);
+            size_t jj = 0;
+
+            {
+                MyHashTable<Node<AR> const*> uniq(m * 2);
+
+                for (size_t j = 0; j < m; ++j) {
+                    Node<AR>& f = row[j];
+                    bool dead = true;
+
+                    for (int b = 0; b < AR; ++b) {
+                        NodeId& ff = f.branch[b];
+                        ff = newId[ff.row()][ff.col()];
+                        if (ff != 0) dead = false;
+                    }
+
+                    if (dead) {
+                        newId[i][j] = 0;
+                    }
+                    else {
+                        Node<AR> const* pp = uniq.add(&f);
+
+                        if (pp == &f) {
+                            newId[i][j] = NodeId(i, jj++, f.branch[0].hasEmpty());
+                        }
+                        else {
+                            newId[i][j] = newId[i][pp - row.data()];
+                        }
+                    }
+                }
+            }
+
+            output.initRow(i, jj);
+            for (size_t j = 0; j < m; ++j) {
+                NodeId const& ff = newId[i][j];
+                if (ff.row() == i) output[i][ff.col()] = row[j];
+            }
+
+            for (size_t t = 0; t < lastUse[i].size(); ++t) {
+                newId[lastUse[i][t]].clear();
+            }
+        }
+
+        *rootPtr = newId[rootPtr->row()][rootPtr->col()];
+        mh.end(output.size());
+    }
+};
+
 /**
  * Breadth-first ZDD subset builder.
  */
@@ -1052,6 +1461,7 @@ public:
         MyVector<size_t> nodeColumn(m);
         int lowestChild = i - 1;
         size_t deadCount = 0;
+        std::exception_ptr error; // rethrown outside the parallel region
 
 #ifdef _OPENMP
         // OpenMP 2.0 does not support reduction(min:lowestChild)
@@ -1120,13 +1530,19 @@ public:
                     mm += jj;
                 }
 
-                output.initRow(i, mm);
+                try {
+                    output.initRow(i, mm);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
             }
 
 #ifdef _OPENMP
 #pragma omp for schedule(dynamic)
 #endif
             for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                if (error) continue;
                 size_t const jj0 = nodeColumn[j] - 1;   // code(p) >= 1
 
                 for (int y = 0; y < threads; ++y) {
@@ -1214,6 +1630,7 @@ public:
             if (lc < lowestChild) lowestChild = lc;
         }
 
+        if (error) std::rethrow_exception(error);
         sweeper.update(i, lowestChild, deadCount);
     }
 
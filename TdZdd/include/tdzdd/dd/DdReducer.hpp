@@ -38,6 +38,7 @@
 #include "../util/MyHashTable.hpp"
 #include "../util/MyList.hpp"
 #include "../util/MyVector.hpp"
+#include "../util/WorkStealing.hpp"
 
 namespace tdzdd {
 
@@ -75,6 +76,7 @@ class DdReducer {
     int const tasks;
     MyVector<MyVector<MyList<ReducNodeInfo> > > taskMatrix;
     MyVector<size_t> baseColumn;
+    WorkStealingLoop loop;
 
 #ifdef DEBUG
     ElapsedTimeCounter etcP1, etcP2, etcP3, etcS0, etcS1, etcS2, etcS3, etcS4;
@@ -96,6 +98,7 @@ public:
             tasks(MyHashConstant::primeSize(TASKS_PER_THREAD * threads)),
             taskMatrix(threads),
             baseColumn(tasks + 1),
+            loop("Reduction", threads),
 #endif
             readyForSequentialReduction(false) {
 #ifdef _OPENMP
@@ -421,8 +424,7 @@ private:
             int y = omp_get_thread_num();
             MyHashTable<ReducNodeInfo const*> uniq;
 
-#pragma omp for schedule(static)
-            for (size_t j = 0; j < m; ++j) {
+            loop.run(i, m, [&](intmax_t j) {
                 Node<ARITY>& f = input[i][j];
 
                 // make f canonical
@@ -438,7 +440,7 @@ private:
 
                 if (del) { // f is redundant
                     newIdTable[i][j] = f0;
-                    continue;
+                    return;
                 }
 
                 // schedule a task
@@ -446,7 +448,7 @@ private:
                 ReducNodeInfo* p = taskMatrix[y][x].alloc_front();
                 p->children = f;
                 p->column = j;
-            }
+            });
 
 #pragma omp single
             {
@@ -464,15 +466,14 @@ private:
 #endif
             }
 
-#pragma omp for schedule(dynamic)
-            for (int x = 0; x < tasks; ++x) {
+            loop.run(i, tasks, [&](intmax_t x) {
                 size_t mm = 0;
                 for (int yy = 0; yy < threads; ++yy) {
                     mm += taskMatrix[yy][x].size();
                 }
                 if (mm == 0) {
                     baseColumn[x + 1] = 0;
-                    continue;
+                    return;
                 }
 
                 uniq.initialize(mm * 2);
@@ -500,7 +501,7 @@ private:
                 }
 
                 baseColumn[x + 1] = j;
-            }
+            }, true);
 
             for (int x = 0; x < tasks; ++x) {
                 taskMatrix[y][x].clear();
@@ -533,8 +534,7 @@ private:
 #endif
             }
 
-#pragma omp for schedule(static)
-            for (size_t j = 0; j < m; ++j) {
+            loop.run(i, m, [&](intmax_t j) {
                 NodeId& ff = newIdTable[i][j];
                 if (ff.row() >= i) {
                     ff = NodeId(i,
@@ -542,7 +542,7 @@ private:
                                 ff.getAttr());
                     output[i][ff.col()] = input[i][j];
                 }
-            }
+            });
         }
 #ifdef DEBUG
         etcP3.stop();
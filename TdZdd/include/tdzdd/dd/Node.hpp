@@ -30,9 +30,28 @@
 
 namespace tdzdd {
 
-int const NODE_ROW_BITS = 20;
+/*
+ * A node ID packs the row (level) and the column of a node into one code.
+ * Defining TDZDD_COMPACT_NODE_ID makes the code 32 bits instead of 64,
+ * which halves the size of node tables at the cost of limiting the number
+ * of levels and the number of nodes per level; TDZDD_NODE_ROW_BITS moves
+ * the border between the row and the column.
+ */
+#ifdef TDZDD_COMPACT_NODE_ID
+typedef uint32_t NodeCode;
+#ifndef TDZDD_NODE_ROW_BITS
+#define TDZDD_NODE_ROW_BITS 10
+#endif
+#else
+typedef uint64_t NodeCode;
+#ifndef TDZDD_NODE_ROW_BITS
+#define TDZDD_NODE_ROW_BITS 20
+#endif
+#endif
+
+int const NODE_ROW_BITS = TDZDD_NODE_ROW_BITS;
 int const NODE_ATTR_BITS = 1;
-int const NODE_COL_BITS = 64 - NODE_ROW_BITS - NODE_ATTR_BITS;
+int const NODE_COL_BITS = sizeof(NodeCode) * 8 - NODE_ROW_BITS - NODE_ATTR_BITS;
 
 int const NODE_ROW_OFFSET = NODE_COL_BITS + NODE_ATTR_BITS;
 int const NODE_ATTR_OFFSET = NODE_COL_BITS;
@@ -44,7 +63,7 @@ uint64_t const NODE_ROW_MASK = NODE_ROW_MAX << NODE_ROW_OFFSET;
 uint64_t const NODE_ATTR_MASK = uint64_t(1) << NODE_ATTR_OFFSET;
 
 class NodeId {
-    uint64_t code_;
+    NodeCode code_;
 
 public:
     NodeId() { // 'code_' is not initialized in the default constructor for SPEED. @suppress("Class members should be properly initialized")
@@ -27,7 +27,9 @@
 #include <algorithm>
 #include <cassert>
 #include <climits>
+#include <memory>
 #include <ostream>
+#include <sstream>
 #include <stdexcept>
 
 #include "Node.hpp"
@@ -40,6 +42,27 @@ template<int ARITY>
 class NodeTableEntity: public DataTable<Node<ARITY> > {
     mutable MyVector<MyVector<int> > higherLevelTable;
     mutable MyVector<MyVector<int> > lowerLevelTable;
+    std::shared_ptr<void const> backing; ///< Keeps external node arrays of rows alive.
+
+    static int checkNumRows(int n) {
+        if (n - 1 > int(NODE_ROW_MAX)) {
+            std::ostringstream oss;
+            oss << "Too many levels for " << NODE_ROW_BITS
+                << "-bit node rows: " << n - 1;
+            throw std::runtime_error(oss.str());
+        }
+        return n;
+    }
+
+    static size_t checkRowSize(int i, size_t size) {
+        if (size > NODE_COL_MAX + 1) {
+            std::ostringstream oss;
+            oss << "Too many nodes at level " << i << " for " << NODE_COL_BITS
+                << "-bit node columns: " << size;
+            throw std::runtime_error(oss.str());
+        }
+        return size;
+    }
 
 public:
     /**
@@ -47,7 +70,7 @@ public:
      * @param n the number of rows.
      */
     NodeTableEntity(int n = 1)
-            : DataTable<Node<ARITY> >(n) {
+            : DataTable<Node<ARITY> >(checkNumRows(n)) {
         assert(n >= 1);
         initTerminals();
     }
@@ -58,8 +81,47 @@ public:
      */
     void init(int n) {
         assert(n >= 1);
-        DataTable<Node<ARITY> >::init(n);
+        DataTable<Node<ARITY> >::init(checkNumRows(n));
         initTerminals();
+        backing.reset();
+    }
+
+    /**
+     * Resizes the table rows.
+     * @param n the number of rows.
+     */
+    void setNumRows(int n) {
+        DataTable<Node<ARITY> >::setNumRows(checkNumRows(n));
+    }
+
+    /**
+     * Clears and initializes a row.
+     * @param i row index.
+     * @param size new size of the row.
+     */
+    void initRow(int i, size_t size) {
+        DataTable<Node<ARITY> >::initRow(i, checkRowSize(i, size));
+    }
+
+    /**
+     * Resizes a row keeping its nodes.
+     * @param i row index.
+     * @param size new size of the row.
+     */
+    void resizeRow(int i, size_t size) {
+        (*this)[i].resize(checkRowSize(i, size));
+    }
+
+    /**
+     * Makes a row a view of an external node array.
+     * @param i row index.
+     * @param nodes start address of the node array.
+     * @param size number of nodes.
+     * @param owner object keeping the node array alive while the table is in use.
+     */
+    void attachRow(int i, Node<ARITY>* nodes, size_t size, std::shared_ptr<void const> const& owner) {
+        (*this)[i].attach(nodes, size);
+        backing = owner;
     }
 
     /**
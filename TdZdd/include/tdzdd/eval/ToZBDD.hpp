@@ -65,10 +65,12 @@ public:
     }
 
     void evalNode(ZBDD& f, int level, tdzdd::DdValues<ZBDD,2> const& values) const {
-        f = values.get(0);
         if (level + offset > 0) {
-            ZBDD f1 = values.get(1);
-            f += f1.Change(BDD_VarOfLev(level + offset));
+            // Children are already converted, so the node is made directly in the unique table
+            f = ZBDD_Node(BDD_VarOfLev(level + offset), values.get(0), values.get(1));
+        }
+        else {
+            f = values.get(0);
         }
     }
 };
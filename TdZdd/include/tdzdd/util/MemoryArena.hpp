@@ -0,0 +1,173 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace tdzdd {
+
+/**
+ * Allocator of large memory blocks backed by huge pages.
+ * In a huge page mode, every block of LARGE_SIZE bytes or more is mapped
+ * on its own with mmap at a huge page boundary, so that it is covered by
+ * as few TLB entries as possible, and is given back to the OS as soon as
+ * it is freed.
+ * Smaller blocks and all blocks in the default mode are allocated with
+ * the global operator new.
+ * Mapped blocks are recorded, so that the mode can be changed at any time.
+ */
+class MemoryArena {
+public:
+    enum Mode {
+        NORMAL_PAGES,       ///< operator new
+        TRANSPARENT_PAGES,  ///< anonymous mapping with MADV_HUGEPAGE
+        EXPLICIT_PAGES      ///< MAP_HUGETLB, or TRANSPARENT_PAGES if not available
+    };
+
+    static size_t const HUGE_PAGE_SIZE = size_t(2) << 20;
+    static size_t const LARGE_SIZE = HUGE_PAGE_SIZE;
+
+private:
+    static Mode& mode() {
+        static Mode m = NORMAL_PAGES;
+        return m;
+    }
+
+    static size_t& poolBlock() {
+        static size_t size = 400000;
+        return size;
+    }
+
+    static std::mutex& mapLock() {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::map<void*,size_t>& mappings() {
+        static std::map<void*,size_t>* m = new std::map<void*,size_t>(); // never destructed before static objects
+        return *m;
+    }
+
+    static void* map(size_t size) {
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (mode() == EXPLICIT_PAGES) {
+            p = mmap(0, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+#endif
+        if (p != MAP_FAILED) return p;
+
+        // Over-allocate by a huge page to cut out an aligned range
+        char* q = static_cast<char*>(mmap(0, size + HUGE_PAGE_SIZE,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (q == MAP_FAILED) return 0;
+        size_t head = (HUGE_PAGE_SIZE - reinterpret_cast<size_t>(q) % HUGE_PAGE_SIZE)
+                % HUGE_PAGE_SIZE;
+        if (head > 0) munmap(q, head);
+        munmap(q + head + size, HUGE_PAGE_SIZE - head);
+#ifdef MADV_HUGEPAGE
+        madvise(q + head, size, MADV_HUGEPAGE);
+#endif
+        return q + head;
+    }
+
+public:
+    /**
+     * Selects the pages for blocks allocated from now on.
+     * @param m the mode.
+     * @return old mode.
+     */
+    static Mode useHugePages(Mode m) {
+        Mode old = mode();
+        mode() = m;
+        return old;
+    }
+
+    /**
+     * Changes the size of blocks in memory pools created from now on.
+     * Blocks of LARGE_SIZE or more are backed by huge pages in a huge
+     * page mode.
+     * @param size block size in bytes.
+     * @return old block size in bytes.
+     */
+    static size_t setPoolBlockSize(size_t size) {
+        size_t old = poolBlock();
+        poolBlock() = size;
+        return old;
+    }
+
+    /**
+     * Gets the size of blocks in memory pools.
+     * @return block size in bytes.
+     */
+    static size_t poolBlockSize() {
+        return poolBlock();
+    }
+
+    /**
+     * Allocates a memory block.
+     * @param n the number of bytes.
+     * @return start address of the block.
+     * @exception std::bad_alloc no memory is available.
+     */
+    static void* allocate(size_t n) {
+        if (mode() == NORMAL_PAGES || n < LARGE_SIZE) return ::operator new(n);
+
+        size_t size = (n + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void* p = map(size);
+        if (p == 0) throw std::bad_alloc();
+
+        std::lock_guard<std::mutex> guard(mapLock());
+        mappings()[p] = size;
+        return p;
+    }
+
+    /**
+     * Frees a memory block.
+     * @param p start address of the block.
+     * @param n the number of bytes.
+     */
+    static void deallocate(void* p, size_t n) {
+        if (n >= LARGE_SIZE) {
+            std::unique_lock<std::mutex> guard(mapLock());
+            std::map<void*,size_t>::iterator t = mappings().find(p);
+            if (t != mappings().end()) {
+                size_t size = t->second;
+                mappings().erase(t);
+                guard.unlock();
+                munmap(p, size);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+} // namespace tdzdd
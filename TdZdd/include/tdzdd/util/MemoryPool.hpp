@@ -24,10 +24,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
 
+#include "MemoryArena.hpp"
 #include "MyVector.hpp"
 
 namespace tdzdd {
@@ -35,6 +37,8 @@ namespace tdzdd {
 /**
  * Memory pool.
  * Allocated memory blocks are kept until the pool is destructed.
+ * Blocks are taken from MemoryArena in the size of
+ * MemoryArena::poolBlockSize() at the creation of the pool.
  */
 class MemoryPool {
     struct Unit {
@@ -42,19 +46,39 @@ class MemoryPool {
     };
 
     static size_t const UNIT_SIZE = sizeof(Unit);
-    static size_t const BLOCK_UNITS = 400000 / UNIT_SIZE;
-    static size_t const MAX_ELEMENT_UNIS = BLOCK_UNITS / 10;
+    static size_t const HEADER_UNITS = 2; ///< link and size of the block
 
     Unit* blockList;
     size_t nextUnit;
+    size_t blockUnits;
+
+    static size_t& blockSize(Unit* block) {
+        return reinterpret_cast<size_t&>(block[1]);
+    }
+
+    static Unit* newBlock(size_t units) {
+        Unit* block = static_cast<Unit*>(MemoryArena::allocate(units * UNIT_SIZE));
+        blockSize(block) = units;
+        return block;
+    }
+
+    static void deleteBlock(Unit* block) {
+        MemoryArena::deallocate(block, blockSize(block) * UNIT_SIZE);
+    }
+
+    static size_t defaultBlockUnits() {
+        return std::max(MemoryArena::poolBlockSize() / UNIT_SIZE, size_t(100));
+    }
 
 public:
     MemoryPool()
-            : blockList(0), nextUnit(BLOCK_UNITS) {
+            : blockList(0), nextUnit(0), blockUnits(defaultBlockUnits()) {
+        nextUnit = blockUnits;
     }
 
     MemoryPool(MemoryPool const& o)
-            : blockList(0), nextUnit(BLOCK_UNITS) {
+            : blockList(0), nextUnit(0), blockUnits(defaultBlockUnits()) {
+        nextUnit = blockUnits;
 //        if (o.blockList != 0) throw std::runtime_error(
 //                "MemoryPool can't be copied unless it is empty!"); //FIXME
     }
@@ -80,6 +104,7 @@ public:
     void moveFrom(MemoryPool& o) {
         blockList = o.blockList;
         nextUnit = o.nextUnit;
+        blockUnits = o.blockUnits;
         o.blockList = 0;
     }
 
@@ -95,9 +120,9 @@ public:
         while (blockList != 0) {
             Unit* block = blockList;
             blockList = blockList->next;
-            delete[] block;
+            deleteBlock(block);
         }
-        nextUnit = BLOCK_UNITS;
+        nextUnit = blockUnits;
     }
 
     void reuse() {
@@ -105,9 +130,13 @@ public:
         while (blockList->next != 0) {
             Unit* block = blockList;
             blockList = blockList->next;
-            delete[] block;
+            deleteBlock(block);
+        }
+        if (blockSize(blockList) != blockUnits) { // a block of a large element
+            clear();
+            return;
         }
-        nextUnit = 1;
+        nextUnit = HEADER_UNITS;
     }
 
     void splice(MemoryPool& o) {
@@ -121,17 +150,18 @@ public:
 
         blockList = o.blockList;
         nextUnit = o.nextUnit;
+        blockUnits = o.blockUnits;
 
         o.blockList = 0;
-        o.nextUnit = BLOCK_UNITS;
+        o.nextUnit = o.blockUnits;
     }
 
     void* alloc(size_t n) {
         size_t const elementUnits = (n + UNIT_SIZE - 1) / UNIT_SIZE;
 
-        if (elementUnits > MAX_ELEMENT_UNIS) {
-            size_t m = elementUnits + 1;
-            Unit* block = new Unit[m];
+        if (elementUnits > blockUnits / 10) {
+            size_t m = elementUnits + HEADER_UNITS;
+            Unit* block = newBlock(m);
             if (blockList == 0) {
                 block->next = 0;
                 blockList = block;
@@ -140,15 +170,15 @@ public:
                 block->next = blockList->next;
                 blockList->next = block;
             }
-            return block + 1;
+            return block + HEADER_UNITS;
         }
 
-        if (nextUnit + elementUnits > BLOCK_UNITS) {
-            Unit* block = new Unit[BLOCK_UNITS];
+        if (nextUnit + elementUnits > blockUnits) {
+            Unit* block = newBlock(blockUnits);
             block->next = blockList;
             blockList = block;
-            nextUnit = 1;
-            assert(nextUnit + elementUnits <= BLOCK_UNITS);
+            nextUnit = HEADER_UNITS;
+            assert(nextUnit + elementUnits <= blockUnits);
         }
 
         Unit* p = blockList + nextUnit;
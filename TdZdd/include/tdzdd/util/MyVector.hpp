@@ -28,20 +28,22 @@
 #include <cstring>
 #include <vector>
 
+#include "MemoryArena.hpp"
+
 namespace tdzdd {
 
 template<typename T, typename Size = size_t>
 class MyVector {
-    Size capacity_;  ///< Size of the array.
+    Size capacity_;  ///< Size of the array; 0 if the array is not owned.
     Size size_;      ///< Current number of elements.
     T* array_;         ///< Start address of the array.
 
     static T* allocate(Size n) {
-        return std::allocator<T>().allocate(n);
+        return static_cast<T*>(MemoryArena::allocate(n * sizeof(T)));
     }
 
     static void deallocate(T* p, Size n) {
-        std::allocator<T>().deallocate(p, n);
+        MemoryArena::deallocate(p, n * sizeof(T));
     }
 
     void ensureCapacity(Size capacity) {
@@ -200,11 +202,11 @@ public:
         if (capacity_ < capacity) {
             T* tmp = allocate(capacity);
             if (array_ != 0) {
-                assert(0 <= size_ && size_ <= capacity_);
+                assert(0 <= size_ && (size_ <= capacity_ || capacity_ == 0));
                 for (Size i = 0; i < size_; ++i) {
                     moveElement(array_[i], tmp[i]);
                 }
-                deallocate(array_, capacity_);
+                if (capacity_ > 0) deallocate(array_, capacity_);
             }
             array_ = tmp;
             capacity_ = capacity;
@@ -256,7 +258,7 @@ public:
                 new (tmp + size_++) T();
             }
 
-            deallocate(array_, capacity_);
+            if (capacity_ > 0) deallocate(array_, capacity_);
             array_ = tmp;
             capacity_ = n;
         }
@@ -289,16 +291,28 @@ public:
      */
     void clear() {
         if (array_ != 0) {
-            assert(capacity_ > 0);
             while (size_ > 0) {
                 array_[--size_].~T();
             }
-            deallocate(array_, capacity_);
+            if (capacity_ > 0) deallocate(array_, capacity_);
             array_ = 0;
         }
         capacity_ = 0;
     }
 
+    /**
+     * Makes this vector a view of an external array without owning it.
+     * The array is copied into an owned one as soon as the vector grows;
+     * elements can be modified in place.
+     * @param array start address of the external array.
+     * @param n number of elements.
+     */
+    void attach(T* array, Size n) {
+        clear();
+        array_ = array;
+        size_ = n;
+    }
+
     /**
      * Adds an element to the end of the array.
      * The array is automatically extended,
@@ -0,0 +1,150 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace tdzdd {
+
+/**
+ * Anonymous scratch file for data that does not fit in memory.
+ * Data are appended sequentially and read back by extents.
+ * The file is unlinked as soon as it is created, so that it disappears
+ * when it is closed even if the process is killed.
+ */
+class SpillFile {
+    int fd;
+    size_t size_;
+
+    SpillFile(SpillFile const&);
+    SpillFile& operator=(SpillFile const&);
+
+    static void fail(char const* what) {
+        throw std::runtime_error(std::string("SpillFile: ") + what + ": "
+                + std::strerror(errno));
+    }
+
+public:
+    /**
+     * Contiguous part of the file.
+     */
+    struct Extent {
+        size_t offset;
+        size_t size;
+    };
+
+    /**
+     * Constructor.
+     * @param dir directory of the file.
+     */
+    SpillFile(std::string const& dir) :
+            size_(0) {
+        std::string path = dir + "/tdzdd-spill-XXXXXX";
+        std::vector<char> buf(path.begin(), path.end());
+        buf.push_back('\0');
+        fd = mkstemp(buf.data());
+        if (fd < 0) fail(buf.data());
+        unlink(buf.data());
+    }
+
+    ~SpillFile() {
+        close(fd);
+    }
+
+    /**
+     * Gets the number of bytes written so far.
+     * @return the file size.
+     */
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * Appends data at the end of the file.
+     * @param data start address of the data.
+     * @param n the number of bytes.
+     * @return the extent of the data.
+     */
+    Extent append(void const* data, size_t n) {
+        Extent e = {size_, n};
+        char const* p = static_cast<char const*>(data);
+        while (n > 0) {
+            ssize_t k = pwrite(fd, p, n, size_);
+            if (k < 0) {
+                if (errno == EINTR) continue;
+                fail("write");
+            }
+            p += k;
+            n -= k;
+            size_ += k;
+        }
+        return e;
+    }
+
+    /**
+     * Reads data back.
+     * @param e the extent of the data.
+     * @param data destination address of the data.
+     */
+    void read(Extent const& e, void* data) const {
+        char* p = static_cast<char*>(data);
+        size_t offset = e.offset;
+        size_t n = e.size;
+        while (n > 0) {
+            ssize_t k = pread(fd, p, n, offset);
+            if (k <= 0) {
+                if (k < 0 && errno == EINTR) continue;
+                fail("read");
+            }
+            p += k;
+            offset += k;
+            n -= k;
+        }
+    }
+
+    /**
+     * Gives back the disk space of data that are no longer used,
+     * if the file system supports it.
+     * @param e the extent of the data.
+     */
+    void release(Extent const& e) {
+#ifdef FALLOC_FL_PUNCH_HOLE
+        fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, e.offset,
+                  e.size);
+#else
+        (void) e;
+#endif
+    }
+};
+
+} // namespace tdzdd
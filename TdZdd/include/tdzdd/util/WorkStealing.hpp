@@ -0,0 +1,253 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "MessageHandler.hpp"
+#include "MyVector.hpp"
+#include "ResourceUsage.hpp"
+
+namespace tdzdd {
+
+/**
+ * Parallel loop over the nodes or tasks of a level, run by every thread of
+ * an OpenMP parallel region.
+ * When work stealing is enabled, the iterations are split evenly into a
+ * range per thread, from which the owner takes chunks at the front, and a
+ * thread out of work steals the back half of the range of another thread.
+ * Otherwise the loop is an OpenMP worksharing loop of the given schedule.
+ * With profiling enabled, the time that threads wait for the slowest one
+ * at the end of each loop is summed up per level and printed on destruction.
+ */
+class WorkStealingLoop {
+    static int const CHUNKS_PER_THREAD = 64;
+
+    struct Range {
+        std::atomic<bool> lock;
+        intmax_t begin;
+        intmax_t end;
+        char padding[64];   ///< keeps ranges of threads on separate cache lines
+
+        Range() :
+                lock(false), begin(0), end(0) {
+        }
+    };
+
+    std::string const name;
+    std::vector<Range> ranges;
+    MyVector<MyVector<double> > idleTime;   ///< idle time of each thread per level
+    MyVector<double> wallTime;              ///< elapsed time of loops per level
+
+    static bool& stealing() {
+        static bool flag = false;
+        return flag;
+    }
+
+    static bool& profiling() {
+        static bool flag = false;
+        return flag;
+    }
+
+    void acquire(Range& r) {
+        while (r.lock.exchange(true, std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void release(Range& r) {
+        r.lock.store(false, std::memory_order_release);
+    }
+
+    bool take(int y, intmax_t grain, intmax_t& begin, intmax_t& end) {
+        Range& r = ranges[y];
+        acquire(r);
+        begin = r.begin;
+        end = std::min(r.begin + grain, r.end);
+        r.begin = end;
+        release(r);
+        return begin < end;
+    }
+
+    bool steal(int y, int threads) {
+        for (int k = 1; k < threads; ++k) {
+            Range& v = ranges[(y + k) % threads];
+            acquire(v);
+            intmax_t mid = v.begin + (v.end - v.begin) / 2;
+            intmax_t end = v.end;
+            if (mid < end) v.end = mid;
+            release(v);
+
+            if (mid < end) {
+                Range& r = ranges[y];
+                acquire(r);
+                r.begin = mid;
+                r.end = end;
+                release(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    /**
+     * Enables or disables work stealing in all parallel loops.
+     * @param flag true for using work stealing.
+     * @return old value of the flag.
+     */
+    static bool useWorkStealing(bool flag = true) {
+        bool old = stealing();
+        stealing() = flag;
+        return old;
+    }
+
+    /**
+     * Enables or disables printing idle time per level of parallel loops.
+     * @param flag true for printing idle time.
+     * @return old value of the flag.
+     */
+    static bool showIdleTime(bool flag = true) {
+        bool old = profiling();
+        profiling() = flag;
+        return old;
+    }
+
+    /**
+     * Constructor.
+     * @param name name of the loop in the idle time report.
+     * @param threads the maximum number of threads.
+     */
+    WorkStealingLoop(std::string const& name, int threads) :
+            name(name), ranges(threads), idleTime(threads) {
+    }
+
+    ~WorkStealingLoop() {
+        if (!profiling() || wallTime.empty()) return;
+
+        MessageHandler mh;
+        mh << "\n" << name << " idle time per level ("
+           << (stealing() ? "work stealing" : "OpenMP schedule") << "):";
+        double idleAll = 0, wallAll = 0;
+
+        for (int i = wallTime.size() - 1; i >= 0; --i) {
+            if (wallTime[i] == 0) continue;
+            double idle = 0;
+            for (size_t y = 0; y < idleTime.size(); ++y) {
+                if (size_t(i) < idleTime[y].size()) idle += idleTime[y][i];
+            }
+            mh << "\n  " << std::setw(4) << i << ": " << std::fixed
+               << std::setprecision(2) << idle * 1000 << " ms of "
+               << ranges.size() << " x " << wallTime[i] * 1000 << " ms";
+            idleAll += idle;
+            wallAll += wallTime[i];
+        }
+
+        mh << "\n  all : " << idleAll * 1000 << " ms of " << ranges.size()
+           << " x " << wallAll * 1000 << " ms\n";
+    }
+
+    /**
+     * Runs f(j) for 0 <= j < m.
+     * It must be called by every thread of an OpenMP parallel region, and
+     * returns when all the threads are done like a worksharing loop.
+     * @param level the level for the idle time report.
+     * @param m the number of iterations.
+     * @param f the loop body.
+     * @param dynamic use schedule(dynamic) instead of schedule(static)
+     *        without work stealing.
+     */
+    template<typename F>
+    void run(int level, intmax_t m, F const& f, bool dynamic = false) {
+#ifdef _OPENMP
+        int const y = omp_get_thread_num();
+        int const threads = omp_get_num_threads();
+        double const start = profiling() ? getWallClockTime() : 0;
+
+        if (stealing()) {
+            Range& r = ranges[y];
+            acquire(r);
+            r.begin = m * y / threads;
+            r.end = m * (y + 1) / threads;
+            release(r);
+#pragma omp barrier
+
+            intmax_t const grain = std::max(m / (threads * CHUNKS_PER_THREAD), intmax_t(1));
+            intmax_t begin, end;
+            do {
+                while (take(y, grain, begin, end)) {
+                    for (intmax_t j = begin; j < end; ++j) {
+                        f(j);
+                    }
+                }
+            } while (steal(y, threads));
+        }
+        else if (dynamic) {
+#pragma omp for schedule(dynamic) nowait
+            for (intmax_t j = 0; j < m; ++j) {
+                f(j);
+            }
+        }
+        else {
+#pragma omp for schedule(static) nowait
+            for (intmax_t j = 0; j < m; ++j) {
+                f(j);
+            }
+        }
+
+        if (!profiling()) {
+#pragma omp barrier
+            return;
+        }
+
+        double const done = getWallClockTime();
+#pragma omp barrier
+        double const finish = getWallClockTime();
+
+        if (idleTime[y].size() <= size_t(level)) idleTime[y].resize(level + 1);
+        idleTime[y][level] += finish - done;
+        if (y == 0) {
+            if (wallTime.size() <= size_t(level)) wallTime.resize(level + 1);
+            wallTime[level] += finish - start;
+        }
+#else
+        for (intmax_t j = 0; j < m; ++j) {
+            f(j);
+        }
+#endif
+    }
+};
+
+} // namespace tdzdd
@@ -5,16 +5,22 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
 #include <tdzdd/DdSpec.hpp>
 
+#include "VariableLayout.hpp"
 #include "GeoDistributedStorageSystem.hpp"
 
 namespace tdzdd {
 
 union ValidConfigMate {
 private:
-    uint16_t hash;          ///< hash for T_{jkt}
-    int16_t faults;         ///< minimum number of DC faults
+    uint32_t bits;          ///< 2-bit states of T_{jk}, packed row by row
+    int32_t faults;         ///< minimum number of DC faults
 
 public:
     // Initialize faults
@@ -30,40 +36,101 @@ public:
         return this != &o;
     }
 
-    friend class ValidConfig;
+    template<int NUM_DC> friend class ValidConfigN;
+};
+
+int const VALID_CONFIG_CELL_BITS = 32;
+
+// Number of cells for T_{jk}, padded so that the state fills whole words
+constexpr int validConfigCells(int numDC) {
+    int rowsPerCell = std::max(1, VALID_CONFIG_CELL_BITS / (2 * numDC));
+    int rowCells = (2 * numDC - 1) / VALID_CONFIG_CELL_BITS + 1;
+    int cells = ((numDC - 1) / rowsPerCell + 1) * rowCells;
+    int perWord = sizeof(size_t) / sizeof(ValidConfigMate);
+    return ((cells + 1 + perWord - 1) / perWord) * perWord - 1;
+}
+
+// Sizes of the ValidConfig state for NUM_DC Data Centers, known at compile time
+template<int NUM_DC>
+struct ValidConfigShape {
+    static constexpr int numDC = NUM_DC;
+    static constexpr int Pwidth = 1 + NUM_DC + NUM_DC * NUM_DC;
+    static constexpr int Twidth = 1 + NUM_DC;
+    static constexpr int rowBits = 2 * NUM_DC;
+    static constexpr int rowsPerCell = std::max(1, VALID_CONFIG_CELL_BITS / (2 * NUM_DC));
+    static constexpr int rowCells = (2 * NUM_DC - 1) / VALID_CONFIG_CELL_BITS + 1;
+    static constexpr int numCells = validConfigCells(NUM_DC);
+    static constexpr uint32_t rowMask = 2 * NUM_DC >= VALID_CONFIG_CELL_BITS ? ~uint32_t(0) : (uint32_t(1) << (2 * NUM_DC)) - 1;
+
+    ValidConfigShape(int numDC) {
+        assert(numDC == NUM_DC);
+    }
+};
+
+// Sizes of the ValidConfig state for any number of Data Centers, known at run time
+template<>
+struct ValidConfigShape<0> {
+    int const numDC;
+    int const Pwidth;
+    int const Twidth;
+    int const rowBits;          ///< bits per row j of T_{jk}
+    int const rowsPerCell;      ///< rows sharing one cell
+    int const rowCells;         ///< cells spanned by one row
+    int const numCells;
+    uint32_t const rowMask;
+
+    ValidConfigShape(int numDC)
+        : numDC(numDC), Pwidth(1 + numDC + numDC * numDC), Twidth(1 + numDC),
+          rowBits(2 * numDC),
+          rowsPerCell(std::max(1, VALID_CONFIG_CELL_BITS / (2 * numDC))),
+          rowCells((2 * numDC - 1) / VALID_CONFIG_CELL_BITS + 1),
+          numCells(validConfigCells(numDC)),
+          rowMask(2 * numDC >= VALID_CONFIG_CELL_BITS ? ~uint32_t(0) : (uint32_t(1) << (2 * numDC)) - 1) {
+    }
 };
 
-class ValidConfig: public PodArrayDdSpec<ValidConfig,ValidConfigMate,2> {
+// ValidConfig specialized for NUM_DC Data Centers; NUM_DC = 0 for any number of Data Centers
+template<int NUM_DC>
+class ValidConfigN: public PodArrayDdSpec<ValidConfigN<NUM_DC>,ValidConfigMate,2>, ValidConfigShape<NUM_DC> {
     typedef ValidConfigMate Mate;
+    typedef ValidConfigShape<NUM_DC> Shape;
+
+    static int const cellBits = VALID_CONFIG_CELL_BITS;
+    static uint32_t const takenBits = 0xAAAAAAAA;   ///< high bit of every 2-bit state
+
+    using Shape::numDC;
+    using Shape::Pwidth;
+    using Shape::Twidth;
+    using Shape::rowBits;
+    using Shape::rowsPerCell;
+    using Shape::rowCells;
+    using Shape::numCells;
+    using Shape::rowMask;
 
     GeoDistributedStorageSystem const& gdss;
+    VariableLayout const& layout;
     std::string const slaOption;
     int const localeCount;
-    int const cellSize;
-    int const numCells;
-    int const Pwidth;
-    int const Twidth;
     int const faults;
-    int const numDC;
     int const numST;
     int const n;
+    std::vector<bool> eventualFeasible; ///< eventualFeasible[j * numST + t] for T_{jkt} under eventual consistency
+    std::vector<bool> strongFeasible;   ///< strongFeasible[j * numST + t] for T_{jkt} under strong consistency
+    std::vector<bool> slaFeasible;      ///< the one of slaOption, all true for no latency SLA
 
-    int pow(int exp) const {
-        if (exp == 0) return 1;
-        else if (exp % 2 == 0) return pow(exp / 2) * pow(exp / 2);
-        else return 3 * pow(exp - 1);
-    }
-
+    // T_{jk} is stored as 0 (undecided), 1 (not taken) or 2 (taken) in 2 bits
     bool setTHash(Mate* mate, int j, int k, int val = 0) const {
         assert (0 <= j && j < numDC);
         assert (0 <= k && k < numDC);
         assert (0 <= val && val < 3);
         
-        if (getTHash(mate, j, k) != 0 && getTHash(mate, j, k) != val) return false;
-        if (getTHash(mate, j, k) == 0) {
-            if (getLC(mate, j) == localeCount && val == 2) return false;    // Exactly LC
-            int t = j + numDC * k;
-            mate[t / cellSize].hash += val * pow(t % cellSize);
+        int curr = getTHash(mate, j, k);
+        if (curr != 0 && curr != val) return false;
+        if (curr == 0) {
+            if (val == 2 && getLC(mate, j) == localeCount) return false;    // Exactly LC
+            int c = (j / rowsPerCell) * rowCells + (2 * k) / cellBits;
+            int shift = (j % rowsPerCell) * rowBits + (2 * k) % cellBits;
+            mate[c].bits |= uint32_t(val) << shift;
         }
         return true;
     }
@@ -72,30 +139,33 @@ class ValidConfig: public PodArrayDdSpec<ValidConfig,ValidConfigMate,2> {
         assert (0 <= j && j < numDC);
         assert (0 <= k && k < numDC);
 
-        int t = j + numDC * k;
-        return mate[t / cellSize].hash / pow(t % cellSize) % 3;
+        int c = (j / rowsPerCell) * rowCells + (2 * k) / cellBits;
+        int shift = (j % rowsPerCell) * rowBits + (2 * k) % cellBits;
+        return (mate[c].bits >> shift) & 3;
     }
 
+    // Number of taken T_{jk} in row j
     int getLC(Mate const* mate, int j) const {
+        assert (0 <= j && j < numDC);
+
+        Mate const* row = mate + (j / rowsPerCell) * rowCells;
+        int shift = (j % rowsPerCell) * rowBits;
         int LC = 0;
-        for (int k = 0; k < numDC; ++k) {
-            if (getTHash(mate, j, k) == 2) ++LC;
+        for (int c = 0; c < rowCells; ++c) {
+            LC += __builtin_popcount((row[c].bits >> shift) & rowMask & takenBits);
         }
         return LC;
     }
 
-    bool doTakeP(Mate* mate, int k, int t) const {
+    bool doTakeP(Mate* mate, int /*k*/, int /*t*/) const {
         // if (mate[numCells].faults == 0) return false         // Exactly F + 1
         if (mate[numCells].faults) mate[numCells].faults -= 1;
         return true;
     }
 
-    bool doNotTakeP(Mate* mate, int k, int t) const {
+    bool doNotTakeP(Mate* mate, int k, int /*t*/, bool lastST) const {
         // If last ST on DC, force Tjkt = 0 for all j except when forced Tjkt = 1
-        std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-        std::string STt = gdss.getStorageTiers(t, "storageTier");
-        int idx = gdss.getIdxStorageTiers(DCk, STt, "dataCenter");
-        if (gdss.getNumStorageTiers(k) == idx + 1) {
+        if (lastST) {
             for (int j = 0; j < numDC; ++j) {
                 if (!setTHash(mate, j, k, 1)) return false;
             }
@@ -103,42 +173,39 @@ class ValidConfig: public PodArrayDdSpec<ValidConfig,ValidConfigMate,2> {
         return true;
     }
 
-    bool SLAConstraint(int j, int k, int t) const {
-        std::string DCj = gdss.getDataCenters(j);
-        std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-        std::string STt = gdss.getStorageTiers(t, "storageTier");
-
-        if (slaOption == "eventual") {
-            if (gdss.getNetworkLatency(DCj, DCk) + gdss.getGetLatency(DCk, STt) > gdss.getSLAGet()) return false;
-            if (gdss.getNetworkLatency(DCj, DCk) + gdss.getPutLatency(DCk, STt) > gdss.getSLAPut()) return false;
+    bool SLAConstraint(std::string const& option, int j, int k, int t) const {
+        if (option == "eventual") {
+            if (gdss.getNetworkLatency(j, k) + gdss.getGetLatency(t) > gdss.getSLAGet()) return false;
+            if (gdss.getNetworkLatency(j, k) + gdss.getPutLatency(t) > gdss.getSLAPut()) return false;
         }
-        if (slaOption == "strong") {
-            if (gdss.getNetworkLatency(DCj, DCk) + gdss.getGetLatency(DCk, STt) + 2 * gdss.getNetworkLatency(DCk, gdss.getCenter()) > gdss.getSLAGet()) return false;
+        if (option == "strong") {
+            int c = gdss.getIdxCenter();
+            if (gdss.getNetworkLatency(j, k) + gdss.getGetLatency(t) + 2 * gdss.getNetworkLatency(k, c) > gdss.getSLAGet()) return false;
             GeoDistributedStorageSystem::Latency maxNetworkLatency = 0;
-            for (std::string dataCenter: gdss.getDataCenters()) maxNetworkLatency = std::max(maxNetworkLatency, gdss.getNetworkLatency(DCk, dataCenter));
-            if (gdss.getNetworkLatency(DCj, DCk) + gdss.getPutLatency(DCk, STt) + 2 * gdss.getNetworkLatency(DCk, gdss.getCenter()) + maxNetworkLatency > gdss.getSLAPut()) return false;
+            for (int l = 0; l < numDC; ++l) maxNetworkLatency = std::max(maxNetworkLatency, gdss.getNetworkLatency(k, l));
+            if (gdss.getNetworkLatency(j, k) + gdss.getPutLatency(t) + 2 * gdss.getNetworkLatency(k, c) + maxNetworkLatency > gdss.getSLAPut()) return false;
         }
         return true;
     }
 
     bool doTakeT(Mate* mate, int j, int k, int t) const {
-        if (!SLAConstraint(j, k, t)) return false;
+        if (!isSLAFeasible(j, t)) return false;
         if (!setTHash(mate, j, k, 2)) return false;
         return true;
     }
 
-    bool doNotTakeT(Mate* mate, int j, int k, int t) const {
+    bool doNotTakeT(Mate* mate, int j, int k, int /*t*/) const {
         if (!setTHash(mate, j, k, 1)) return false;
         return true;
     }
 
-    bool doTakeB(Mate* mate, int i, int j, int k, int t) const {
+    bool doTakeB(Mate* mate, int i, int j, int k, int /*t*/) const {
         if (j == k) return false;
         if (!setTHash(mate, i, j, 2)) return false;
         return true;
     }
 
-    bool doNotTakeB(Mate* mate, int i, int j, int k, int t) const {
+    bool doNotTakeB(Mate* mate, int i, int j, int k, int /*t*/) const {
         if (j == k) return true;
         if (!setTHash(mate, i, j, 1)) return false;
         return true;
@@ -163,31 +230,55 @@ class ValidConfig: public PodArrayDdSpec<ValidConfig,ValidConfigMate,2> {
     }
 
     // Get level of next DC
-    int nextDC(int i, int j, int k, int t) const {
-        if (i + 1 == numDC && j + 1 == numDC) {
-            std::string DCk = gdss.getStorageTiers(t, "dataCenter");
-            std::string STt = gdss.getStorageTiers(t, "storageTier");
-            int idx = gdss.getIdxStorageTiers(DCk, STt, "dataCenter");
-            return (gdss.getNumStorageTiers(k) - idx - 1) * Pwidth + 1;
+    int nextDC(VariableLayout::Variable const& var) const {
+        if (var.i + 1 == numDC && var.j + 1 == numDC) {
+            return var.remaining * Pwidth + 1;
         }
         return 0;
     }
 
 public:
-    ValidConfig(GeoDistributedStorageSystem const& gdss, std::string slaOption)
-            : gdss(gdss), slaOption(slaOption),
-              numDC(gdss.getNumDataCenters()), numST(gdss.getNumStorageTiers()),
-              Pwidth(1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters()),
-              Twidth(1 + gdss.getNumDataCenters()), 
-              n(gdss.getNumStorageTiers() * (1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters())),
-              cellSize(10),     // log_3 (2^16-1)
-              numCells((gdss.getNumDataCenters() * gdss.getNumDataCenters() - 1) / cellSize + 1),
-              localeCount(gdss.getLC()), faults(gdss.getF()) {
+    ValidConfigN(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::string slaOption)
+            : Shape(gdss.getNumDataCenters()), gdss(gdss), layout(layout), slaOption(slaOption),
+              localeCount(gdss.getLC()), faults(gdss.getF()), numST(gdss.getNumStorageTiers()),
+              n(gdss.getNumStorageTiers() * (1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters())) {
             this->setArraySize(numCells + 1);
+
+            // Precompute latency SLA constraint for every (requester, Storage Tier) pair under both options;
+            // no pair meets strong consistency without a centralized DC location
+            eventualFeasible.resize(numDC * numST);
+            strongFeasible.resize(numDC * numST, false);
+            bool const strong = gdss.hasCenter() || slaOption == "strong";
+            for (int j = 0; j < numDC; ++j) {
+                for (int t = 0; t < numST; ++t) {
+                    eventualFeasible[j * numST + t] = SLAConstraint("eventual", j, gdss.getDataCenterIdx(t), t);
+                    if (strong) strongFeasible[j * numST + t] = SLAConstraint("strong", j, gdss.getDataCenterIdx(t), t);
+                }
+            }
+            slaFeasible = (slaOption == "strong") ? strongFeasible
+                        : (slaOption == "eventual") ? eventualFeasible : std::vector<bool>(numDC * numST, true);
+    }
+
+    // Check if j-th Data Center can be served by t-th Storage Tier within the latency SLA
+    bool isSLAFeasible(int j, int t) const {
+        assert(0 <= j && j < numDC && 0 <= t && t < numST);
+        return slaFeasible[j * numST + t];
+    }
+
+    // Get latency SLA feasibility of all (requester, Storage Tier) pairs, indexed by j * numST + t
+    std::vector<bool> const& getSLAFeasibility() const {
+        return slaFeasible;
+    }
+
+    // Get latency SLA feasibility of all (requester, Storage Tier) pairs under option, "strong" or "eventual"
+    std::vector<bool> const& getSLAFeasibility(std::string const& option) const {
+        if (option == "strong") return strongFeasible;
+        if (option == "eventual") return eventualFeasible;
+        throw std::runtime_error("ERROR: Unknown latency SLA option " + option);
     }
 
     int getRoot(Mate* mate) const {
-        for (int i = 0; i < numCells; ++i) mate[i].hash = 0;
+        for (int i = 0; i < numCells; ++i) mate[i].bits = 0;
         mate[numCells] = Mate(faults + 1);
 
         return n;
@@ -195,61 +286,47 @@ public:
 
     int getChild(Mate* mate, int level, int take) const {
         assert(1 <= level && level <= n);
-        int invLevel = n - level;
+        VariableLayout::Variable const& var = layout[level];
 
         // P_{kt}
-        if (invLevel % Pwidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-
-            if (!lookaheadCheck(mate, k)) return 0;
+        if (var.kind == VariableLayout::P) {
+            if (!lookaheadCheck(mate, var.k)) return 0;
             if (take) {
-                if (!doTakeP(mate, k, t)) return 0;
+                if (!doTakeP(mate, var.k, var.t)) return 0;
             }
             else {
-                if (!doNotTakeP(mate, k, t)) return 0;
+                if (!doNotTakeP(mate, var.k, var.t, var.remaining == 0)) return 0;
                 if (level == Pwidth) return constraintsCheck(mate) ? -1 : 0;
                 return level - Pwidth;
             }
         }
         // T_{jkt}
-        else if ((invLevel % Pwidth - 1) % Twidth == 0) {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-
+        else if (var.kind == VariableLayout::T) {
             if (take) {
-                if (!doTakeT(mate, j, k, t)) return 0;
+                if (!doTakeT(mate, var.j, var.k, var.t)) return 0;
             }
             else {
-                if (!doNotTakeT(mate, j, k, t)) return 0;
+                if (!doNotTakeT(mate, var.j, var.k, var.t)) return 0;
             }
 
         }
         // B_{ijkt}
         else {
-            int t = invLevel / Pwidth;
-            int k = gdss.getIdxDataCenters(gdss.getStorageTiers(t, "dataCenter"));
-            int j = (invLevel % Pwidth - 1) / Twidth;
-            int i = (invLevel % Pwidth - 1) % Twidth - 1;
-            
             if (take) {
-                if (!doTakeB(mate, i, j, k, t)) return 0;
+                if (!doTakeB(mate, var.i, var.j, var.k, var.t)) return 0;
             }
             else {
-                if (!doNotTakeB(mate, i, j, k, t)) return 0;
+                if (!doNotTakeB(mate, var.i, var.j, var.k, var.t)) return 0;
             }
 
-            if (nextDC(i, j, k, t)) {
-                if (level == nextDC(i, j, k, t)) return constraintsCheck(mate) ? -1 : 0;
-                return level - nextDC(i, j, k, t);
+            if (int skip = nextDC(var)) {
+                if (level == skip) return constraintsCheck(mate) ? -1 : 0;
+                return level - skip;
             }
         }
 
-        if (++invLevel == n) return constraintsCheck(mate) ? -1 : 0;
-        
-        assert(invLevel < n);
-        return n - invLevel;
+        if (level == 1) return constraintsCheck(mate) ? -1 : 0;
+        return level - 1;
     }
 
     int numVariables() {
@@ -257,4 +334,6 @@ public:
     }
 };
 
+typedef ValidConfigN<0> ValidConfig;
+
 } // namespace tdzdd
\ No newline at end of file
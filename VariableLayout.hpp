@@ -0,0 +1,94 @@
+/*
+ * A precomputed decoding of ZDD levels into the variables P_{kt}, T_{jkt} and B_{ijkt} of the
+ * Geo-Distributed Multi-Cloud Data Center Storage Tiering and Selection Problem
+ *
+ * Variables are ordered per Storage Tier t as P_{kt}, then T_{jkt} followed by B_{ijkt} for each j;
+ * level n corresponds to P_{k0} and level 1 to B_{(numDC-1)(numDC-1)k(numST-1)}
+ */
+
+#pragma once
+
+#include <cassert>
+#include <vector>
+
+#include "GeoDistributedStorageSystem.hpp"
+
+class VariableLayout {
+public:
+    enum Kind { P, T, B };
+
+    struct Variable {
+        Kind kind;          ///< P_{kt}, T_{jkt} or B_{ijkt}
+        int i;              ///< requesting Data Center of B_{ijkt}, -1 otherwise
+        int j;              ///< Data Center of T_{jkt} and B_{ijkt}, -1 otherwise
+        int k;              ///< Data Center of t-th Storage Tier
+        int t;              ///< index of Storage Tier
+        int tier;           ///< index of t-th Storage Tier within k-th Data Center
+        int remaining;      ///< number of Storage Tiers of k-th Data Center after t-th Storage Tier
+    };
+
+private:
+    int numDC;
+    int numST;
+    int Pwidth;
+    int Twidth;
+    int n;
+    std::vector<Variable> variables;    ///< variables[level], variables[0] is not used
+
+public:
+    VariableLayout(GeoDistributedStorageSystem const& gdss)
+            : numDC(gdss.getNumDataCenters()), numST(gdss.getNumStorageTiers()),
+              Pwidth(1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters()),
+              Twidth(1 + gdss.getNumDataCenters()),
+              n(gdss.getNumStorageTiers() * (1 + gdss.getNumDataCenters() + gdss.getNumDataCenters() * gdss.getNumDataCenters())),
+              variables(n + 1) {
+        for (int level = 1; level <= n; ++level) {
+            int invLevel = n - level;
+            Variable& var = variables[level];
+
+            var.t = invLevel / Pwidth;
+            var.k = gdss.getDataCenterIdx(var.t);
+            var.tier = gdss.getStorageTierIdx(var.t);
+            var.remaining = gdss.getNumStorageTiers(var.k) - var.tier - 1;
+
+            // P_{kt}
+            if (invLevel % Pwidth == 0) {
+                var.kind = P;
+                var.i = var.j = -1;
+            }
+            // T_{jkt}
+            else if ((invLevel % Pwidth - 1) % Twidth == 0) {
+                var.kind = T;
+                var.i = -1;
+                var.j = (invLevel % Pwidth - 1) / Twidth;
+            }
+            // B_{ijkt}
+            else {
+                var.kind = B;
+                var.j = (invLevel % Pwidth - 1) / Twidth;
+                var.i = (invLevel % Pwidth - 1) % Twidth - 1;
+            }
+        }
+    }
+
+    // Get the variable at level
+    Variable const& operator[](int level) const {
+        assert(1 <= level && level <= n);
+        return variables[level];
+    }
+
+    // Get number of levels per Storage Tier
+    int getPwidth() const {
+        return Pwidth;
+    }
+
+    // Get number of levels per T_{jkt} and its B_{ijkt}
+    int getTwidth() const {
+        return Twidth;
+    }
+
+    // Get number of variables
+    int numVariables() const {
+        return n;
+    }
+};
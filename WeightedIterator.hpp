@@ -6,19 +6,22 @@
 #pragma once
 
 #include <set>
-#include <map>
 #include <vector>
 #include <iterator>
 
 #include <ZBDD.h>
+
+// Only bddNodeIndex is used; SBDD_helper.h derives its iterators from the deprecated std::iterator
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #include <SBDD_helper.h>
+#pragma GCC diagnostic pop
 
 // weighted_iterator for ZBDD
 template<typename V = int, typename T = V>
 class weighted_iterator : public std::iterator<std::forward_iterator_tag,std::set<int32_t>> {
     ZBDD zdd_;
     V curr_weight_;
-    int32_t num_elems_;
     bool is_maximizing;
     std::set<int32_t> s_;
     std::vector<T> weights_;    // weights_[0] is not used
@@ -26,7 +29,7 @@ class weighted_iterator : public std::iterator<std::forward_iterator_tag,std::se
 public:
     weighted_iterator(const ZBDD& zdd_, std::vector<T> weights, bool is_maximizing=true) : 
         zdd_(zdd_), s_(std::set<int32_t>()), weights_(weights), 
-        num_elems_(zdd_.Top()), is_maximizing(is_maximizing) {
+        is_maximizing(is_maximizing) {
         if (!is_maximizing) {
             std::vector<T> inverted_weights_;
             for (typename std::vector<T>::const_iterator i = weights.begin(); i != weights.end(); ++i)
@@ -121,58 +124,55 @@ private:
     }
 
     // Algorithm B modified for ZDD, from Knuth Vol. 4 Fascicle 1 Sec. 7.1.4.
+    // Nodes are numbered densely level by level with bddNodeIndex, so that the bottom-up pass
+    // runs over flat arrays in topological order without recursion
     void algo_b(ZBDD f, const std::vector<T>& w, std::vector<bool>* x) {
         assert(x != NULL);
         assert(f != bot());
         if (f == top()) return;
-        std::vector<std::vector<ZBDD>> stacks(num_elems_ + 1);
-        std::set<bddword> visited;
-        int32_t max_elem = 0;
-        sort_zdd(f, &stacks, &visited, &max_elem);
+        sbddh::bddNodeIndex* index = sbddh::bddNodeIndex_makeIndexZWithoutCount(id(f));
+        int32_t max_elem = elem(f);
         assert(w.size() > static_cast<size_t>(max_elem));
         x->clear();
         x->resize(max_elem + 1, false);
-        std::map<bddword,bool> t;
-        std::map<bddword,V> ms;
-        ms[id(bot())] = std::numeric_limits<V>::min();
-        ms[id(top())] = 0;
-        for (int32_t v = 1; v <= max_elem; ++v) {        // Reversed from Graphillion
-            while (!stacks[v].empty()) {
-                ZBDD g = stacks[v].back();
-                stacks[v].pop_back();
-                bddword k = id(g);
-                int32_t v = elem(g);
-                bddword l = id(lo(g));
-                bddword h = id(hi(g));
-                if (lo(g) != bot())
-                    ms[k] = ms.at(l);
-                if (hi(g) != bot()) {
-                    V m = ms.at(h) + w[v];
-                    if (lo(g) == bot() || m > ms.at(k)) {
+
+        // Node ids: 0 and 1 are the terminals, the nodes at level i are offset_arr[i], offset_arr[i] + 1, ...
+        sbddh::llint num_nodes = index->offset_arr[0];
+        std::vector<int32_t> elem_id(num_nodes);
+        std::vector<sbddh::llint> lo_id(num_nodes), hi_id(num_nodes);
+        std::vector<V> ms(num_nodes);
+        std::vector<char> t(num_nodes, false);
+        ms[0] = std::numeric_limits<V>::min();
+        ms[1] = 0;
+        for (int i = 1; i <= index->height; ++i) {        // Reversed from Graphillion
+            for (sbddh::llint k = index->offset_arr[i]; k < index->offset_arr[i - 1]; ++k) {
+                bddp g = (bddp)sbddh::sbddextended_MyVector_get(&index->level_vec_arr[i], k - index->offset_arr[i]);
+                int32_t v = elem_id[k] = bddtop(g);
+                sbddh::llint l = lo_id[k] = node_id(index, sbddh::bddgetchild0z(g));
+                sbddh::llint h = hi_id[k] = node_id(index, sbddh::bddgetchild1z(g));
+                if (l != 0)
+                    ms[k] = ms[l];
+                if (h != 0) {
+                    V m = ms[h] + w[v];
+                    if (l == 0 || m > ms[k]) {
                         ms[k] = m;
                         t[k] = true;
                     }
                 }
             }
         }
-        while (!is_term(f)) {
-            bddword k = id(f);
-            int32_t v = elem(f);
-            if (t.find(k) == t.end())
-                t[k] = false;
-            (*x)[v] = t.at(k);
-            f = !t.at(k) ? lo(f) : hi(f);
-        }
+        for (sbddh::llint k = index->offset_arr[index->height]; k > 1; k = t[k] ? hi_id[k] : lo_id[k])
+            (*x)[elem_id[k]] = t[k];
+        sbddh::bddNodeIndex_destruct(index);
+        free(index);
     }
 
-    void sort_zdd(ZBDD f, std::vector<std::vector<ZBDD>>* stacks, std::set<bddword>* visited, int32_t* max_elem) {
-        assert(stacks != NULL && visited != NULL);
-        if (is_term(f)) return;
-        if (visited->find(id(f)) != visited->end()) return;
-        (*stacks)[elem(f)].push_back(f);
-        visited->insert(id(f));
-        if (max_elem != NULL && elem(f) > *max_elem) *max_elem = elem(f);
-        sort_zdd(lo(f), stacks, visited, max_elem);
-        sort_zdd(hi(f), stacks, visited, max_elem);
+    sbddh::llint node_id(sbddh::bddNodeIndex* index, bddp g) {
+        if (g == bddempty) return 0;
+        if (g == bddsingle) return 1;
+        int level = sbddh::bddgetlev(g);
+        sbddh::llint k = 0;
+        sbddh::sbddextended_MyDict_find(&index->node_dict_arr[level], (sbddh::llint)g, &k);
+        return index->offset_arr[level] + k;
     }
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+ * An on-disk cache of reduced ValidConfig ZDDs keyed by the structural inputs of ValidConfig
+ *
+ * ValidConfig depends only on the Data Centers and their Storage Tiers, the latencies, the SLA
+ * thresholds, LC, F, the central DC location and the SLA option, so any change in costs, object size
+ * or requests can reuse a ZDD built before. Each ZDD is stored as <dir>/<key>.zdd in the format of
+ * ZddFile.hpp, tagged with the inputs it was built from, so that a hash collision or a stale file is
+ * detected on loading
+ */
+
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <stdint.h>
+
+#include "ZddFile.hpp"
+#include "GeoDistributedStorageSystem.hpp"
+
+namespace tdzdd {
+
+// Get the structural inputs of the ValidConfig ZDD of gdss as text
+inline std::string zddCacheInputs(GeoDistributedStorageSystem const& gdss, std::string const& slaOption) {
+    int numDC = gdss.getNumDataCenters();
+    int numST = gdss.getNumStorageTiers();
+
+    std::ostringstream inputs;
+    inputs << std::setprecision(17) << "ValidConfig " << slaOption << " " << numDC << " " << numST;
+    for (int t = 0; t < numST; ++t) {
+        inputs << " " << gdss.getDataCenterIdx(t) << " " << gdss.getGetLatency(t) << " " << gdss.getPutLatency(t);
+    }
+    for (int k1 = 0; k1 < numDC; ++k1) {
+        for (int k2 = 0; k2 < numDC; ++k2) {
+            inputs << " " << gdss.getNetworkLatency(k1, k2);
+        }
+    }
+    inputs << " " << gdss.getSLAGet() << " " << gdss.getSLAPut() << " " << gdss.getLC() << " " << gdss.getF()
+           << " " << gdss.getIdxCenter();
+    return inputs.str();
+}
+
+// Get the cache key of the structural inputs as a 64-bit FNV-1a hash in hex
+inline std::string zddCacheKey(std::string const& inputs) {
+    uint64_t h = 14695981039346656037ULL;
+    for (char c: inputs) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << h;
+    return key.str();
+}
+
+} // namespace tdzdd
@@ -0,0 +1,178 @@
+/*
+ * A versioned binary file format for reduced ZDDs, loaded by memory-mapping the file and using its
+ * node arrays in place
+ *
+ * Layout, in native byte order:
+ *   char     magic[8]          "TRIPSZDD"
+ *   uint32_t version           ZDD_FILE_VERSION
+ *   uint32_t nodeSize          sizeof(Node<2>)
+ *   uint32_t rowBits           NODE_ROW_BITS, the number of bits of the level in a node code
+ *   uint32_t numVariables      number of variables of the instance the ZDD was built for
+ *   uint64_t root              code of the root node
+ *   uint64_t numLevels         level of the root node, n
+ *   uint64_t tagSize           number of bytes in tag
+ *   char     tag[tagSize]      text identifying what the ZDD was built from, padded with '\0' to 8 bytes
+ *   uint64_t count[n]          number of nodes at levels 1, ..., n
+ *   Node<2>  nodes[...]        nodes at levels 1, ..., n, each level contiguous
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <tdzdd/DdStructure.hpp>
+
+namespace tdzdd {
+
+char const ZDD_FILE_MAGIC[8] = {'T', 'R', 'I', 'P', 'S', 'Z', 'D', 'D'};
+uint32_t const ZDD_FILE_VERSION = 3;
+
+struct ZddFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeSize;
+    uint32_t rowBits;
+    uint32_t numVariables;
+    uint64_t root;
+    uint64_t numLevels;
+    uint64_t tagSize;
+};
+
+// Get the number of bytes taken by a tag of tagSize bytes with its padding
+inline size_t zddFileTagBytes(uint64_t tagSize) {
+    return (tagSize + 7) / 8 * 8;
+}
+
+// Write the reduced ZDD dd over numVariables variables to path with tag, through a temporary file so
+// that readers never see a partial one
+inline bool saveZdd(DdStructure<2> const& dd, std::string const& path, int numVariables,
+                    std::string const& tag = std::string()) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream os(tmp, std::ios::binary);
+        NodeTableEntity<2> const& diagram = *dd.getDiagram();
+        int n = dd.topLevel();
+
+        ZddFileHeader header;
+        std::memcpy(header.magic, ZDD_FILE_MAGIC, sizeof(header.magic));
+        header.version = ZDD_FILE_VERSION;
+        header.nodeSize = sizeof(Node<2>);
+        header.rowBits = NODE_ROW_BITS;
+        header.numVariables = numVariables;
+        header.root = dd.root().code();
+        header.numLevels = n;
+        header.tagSize = tag.size();
+        os.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        std::string padded = tag;
+        padded.resize(zddFileTagBytes(tag.size()), '\0');
+        os.write(padded.data(), padded.size());
+
+        std::vector<uint64_t> count(n + 1);
+        for (int i = 1; i <= n; ++i) count[i] = diagram[i].size();
+        os.write(reinterpret_cast<char const*>(count.data() + 1), n * sizeof(uint64_t));
+
+        for (int i = 1; i <= n; ++i) {
+            os.write(reinterpret_cast<char const*>(diagram[i].data()), count[i] * sizeof(Node<2>));
+        }
+        if (!os) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// Check that every child of the nodes at levels 1, ..., n is a terminal or a node at a lower level
+inline bool checkZddNodes(Node<2> const* nodes, uint64_t const* count, uint64_t n) {
+    for (uint64_t i = 1; i <= n; ++i) {
+        for (uint64_t j = 0; j < count[i]; ++j, ++nodes) {
+            for (int b = 0; b < 2; ++b) {
+                NodeId f = nodes->branch[b];
+                uint64_t row = f.row();
+                if (row >= i || f.col() >= (row == 0 ? 2 : count[row])) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Map a reduced ZDD written by saveZdd from path into dd without copying its nodes; false if path is
+// missing, not a ZDD file of this version and node layout, not built for numVariables variables, or
+// tagged other than tag when tag is given
+// Only the header and the node counts are checked unless verify is set, since checking the children of
+// every node reads the whole file; a damaged file that passes the cheap checks is undefined behavior
+inline bool mapZdd(std::string const& path, DdStructure<2>& dd, int numVariables, bool useMP = false,
+                   std::string const* tag = 0, bool verify = false) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    void* p = (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(ZddFileHeader))
+            ? mmap(0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED) return false;
+
+    // Nodes are modified copy-on-write in memory, never in the file
+    size_t const size = st.st_size;
+    std::shared_ptr<void const> mapping(p, [size](void const* q) {
+        munmap(const_cast<void*>(q), size);
+    });
+
+    char* const base = static_cast<char*>(p);
+    ZddFileHeader const& header = *reinterpret_cast<ZddFileHeader const*>(base);
+    if (std::memcmp(header.magic, ZDD_FILE_MAGIC, sizeof(header.magic)) != 0) return false;
+    if (header.version != ZDD_FILE_VERSION || header.nodeSize != sizeof(Node<2>)) return false;
+    if (header.rowBits != uint32_t(NODE_ROW_BITS)) return false;
+    if (header.numVariables != uint32_t(numVariables)) return false;
+    if (header.tagSize > size - sizeof(header)) return false;
+    size_t const tagBytes = zddFileTagBytes(header.tagSize);
+    if (tagBytes > size - sizeof(header)) return false;
+    if (tag && std::string(base + sizeof(header), header.tagSize) != *tag) return false;
+
+    uint64_t const n = header.numLevels;
+    if (n > uint64_t(numVariables)) return false;
+    if (n == 0) {
+        if (header.root > 1) return false;
+        dd = (header.root == 1) ? DdStructure<2>(0, useMP) : DdStructure<2>();
+        return true;
+    }
+    if (NodeId(header.root) != NodeId(n, 0)) return false;
+    if ((size - sizeof(header) - tagBytes) / sizeof(uint64_t) < n) return false;
+
+    uint64_t const* count = reinterpret_cast<uint64_t const*>(base + sizeof(header) + tagBytes) - 1;
+    size_t offset = sizeof(header) + tagBytes + n * sizeof(uint64_t);
+    for (uint64_t i = 1; i <= n; ++i) {
+        if (count[i] > NODE_COL_MAX || count[i] > (size - offset) / sizeof(Node<2>)) return false;
+        offset += count[i] * sizeof(Node<2>);
+    }
+    if (offset != size || count[n] == 0) return false;
+
+    Node<2>* const first = reinterpret_cast<Node<2>*>(base + sizeof(header) + tagBytes + n * sizeof(uint64_t));
+    if (verify && !checkZddNodes(first, count, n)) return false;
+
+    // The universal ZDD of n variables has its root at (n, 0); its rows are replaced with views of the file
+    DdStructure<2> loaded(n, useMP);
+    NodeTableEntity<2>& diagram = loaded.getDiagram().privateEntity();
+    Node<2>* nodes = first;
+    for (uint64_t i = 1; i <= n; ++i) {
+        diagram.attachRow(i, nodes, count[i], mapping);
+        nodes += count[i];
+    }
+
+    dd = loaded;
+    return true;
+}
+
+} // namespace tdzdd
@@ -1,10 +1,21 @@
 #include <map>
+#include <chrono>
 #include <vector>
 #include <iomanip>
+#include <functional>
+
+// POSIX
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
 
 // SAPPOROBDD
 #include <ZBDD.h>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #include <SBDD_helper.h>
+#pragma GCC diagnostic pop
 
 // TdZdd
 #include <tdzdd/DdEval.hpp>
@@ -13,8 +24,15 @@
 #include <tdzdd/eval/ToZBDD.hpp>
 
 #include "GetConfig.hpp"
+#include "KBestConfig.hpp"
+#include "MinCostConfig.hpp"
+#include "MinCostSearch.hpp"
+#include "NearOptimalConfig.hpp"
+#include "RandomConfig.hpp"
 #include "ValidConfig.hpp"
+#include "VariableLayout.hpp"
 #include "WeightedIterator.hpp"
+#include "ZddCache.hpp"
 #include "GeoDistributedStorageSystem.hpp"
 
 typedef GeoDistributedStorageSystem::Cost Cost;
@@ -27,14 +45,40 @@ using namespace sbddh;
 std::string options[][2] = { //
         {"dcList", "Input GDSS instance from STDIN"}, //
         {"strongSLA", "Strong consistency in latency SLA constraint"}, //
-        {"openMP", "Use openMP in construction of ZDD"}, //                     OMP_NUM_THREADS=THREADS
+        {"openMP", "Use openMP in construction and evaluation of ZDD"}, //                     OMP_NUM_THREADS=THREADS
+        {"workStealing", "Use work stealing in openMP construction, reduction and evaluation of ZDD"}, //
+        {"idleTime", "Print idle time of threads per level in openMP algorithms"}, //
+        {"spill <file>", "Spill ZDD construction beyond the buffer to a scratch file in directory"}, //
+        {"buffer <n>", "Keep n MB of ZDD construction in memory with -spill, 1024 by default"}, //
+        {"hugePages", "Back large arrays and memory pools with transparent huge pages"}, //
+        {"hugeTLB", "Back large arrays and memory pools with reserved huge pages, if any"}, //
+        {"poolBlock <n>", "Allocate memory pools in blocks of n KB, 400 or 2048 with huge pages by default"}, //
+        {"optimize", "Get an optimal data placement without building the ZDD"}, //
+        {"infeasible", "Report the Storage Tiers violating the latency SLA for each requester without building the ZDD"}, //
+        {"cache <file>", "Reuse ZDDs of identical latencies, SLA and goals from directory"}, //
+        {"save <file>", "Write resulting ZDD to file in binary format"}, //
+        {"load <file>", "Map ZDD from file in binary format instead of constructing it"}, //
+        {"verify", "Check every node of the ZDD mapped with -load, reading the whole file"}, //
         {"zdd", "Dump resulting ZDD to STDOUT in DOT format"}, //
         {"export", "Dump resulting ZDD to STDOUT"}, //
-        {"getconfig <n>", "Get the first n optimal data placements"} //
+        {"getconfig <n>", "Get the first n optimal data placements"}, //
+        {"zbdd", "Get the optimal data placements from ZBDD of SAPPOROBDD"}, //
+        {"memory <n>", "Limit SAPPOROBDD to n MB, the cgroup memory limit by default"}, //
+        {"epsilon <x>", "Get all data placements within (1+eps) of the minimum cost"}, //
+        {"stream <n>", "Stream the first n optimal data placements as JSON lines, all if n = 0"}, //
+        {"timeLimit <n>", "Stop streaming optimal data placements after n milliseconds"}, //
+        {"sample <n>", "Draw n random data placements as JSON lines"}, //
+        {"beta <x>", "Draw data placements with probability proportional to exp(-beta*cost)"}, //
+        {"seed <n>", "Seed of random data placements"}, //
+        {"serve", "Answer JSON requests from STDIN with the ZDD kept in memory"}, //          one request per line
+        {"socket <file>", "Answer JSON requests on a Unix domain socket with the ZDD kept in memory"}, //
+        {"batch <file>", "Get an optimal data placement for each object workload in file"} //    one query JSON per line
     };
 
 std::map<std::string,bool> opt;
 std::map<std::string,int> optNum;
+std::map<std::string,double> optReal;
+std::map<std::string,std::string> optStr;
 
 void usage(char const* cmd) {
     std::cerr << "usage:" << cmd << " [ <cost_info> <monitoring_info> <query> <goals> ] [ <options>... ] \n";
@@ -48,6 +92,291 @@ void usage(char const* cmd) {
     }
 }
 
+// Construct the ZDD of ValidConfig specialized for numDC Data Centers, if available
+template<int NUM_DC>
+DdStructure<2> constructValidConfig(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::string slaOption, bool useMP) {
+    if (gdss.getNumDataCenters() == NUM_DC) return DdStructure<2>(ValidConfigN<NUM_DC>(gdss, layout, slaOption), useMP);
+    return constructValidConfig<NUM_DC - 1>(gdss, layout, slaOption, useMP);
+}
+
+template<>
+DdStructure<2> constructValidConfig<1>(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::string slaOption, bool useMP) {
+    return DdStructure<2>(ValidConfig(gdss, layout, slaOption), useMP);
+}
+
+// Construct and reduce the ZDD of ValidConfig, reusing the one in cacheDir built from identical structural
+// inputs if any; a cached file built from other inputs is rebuilt
+DdStructure<2> reducedValidConfig(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::string slaOption,
+                                  bool useMP, std::string const& cacheDir) {
+    DdStructure<2> dd;
+    std::string inputs = cacheDir.empty() ? "" : zddCacheInputs(gdss, slaOption);
+    std::string path = cacheDir.empty() ? "" : cacheDir + "/" + zddCacheKey(inputs) + ".zdd";
+    if (!path.empty()) {
+        MessageHandler mh;
+        mh.begin("Loading " + path);
+        if (mapZdd(path, dd, layout.numVariables(), useMP, &inputs)) {
+            mh.end(dd.size());
+            return dd;
+        }
+        mh.end("not usable");
+    }
+
+    dd = constructValidConfig<16>(gdss, layout, slaOption, useMP);
+    dd.zddReduce();
+    if (!path.empty()) saveZdd(dd, path, layout.numVariables(), inputs);
+    return dd;
+}
+
+// Get an optimal data placement of ValidConfig specialized for numDC Data Centers, if available
+template<int NUM_DC>
+Cost optimizeValidConfig(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::string slaOption, std::set<int>& config) {
+    if (gdss.getNumDataCenters() != NUM_DC) return optimizeValidConfig<NUM_DC - 1>(gdss, layout, slaOption, config);
+    MinCostSearch<ValidConfigN<NUM_DC>,Cost> search(ValidConfigN<NUM_DC>(gdss, layout, slaOption), getCost(gdss, layout));
+    config = search.getConfig();
+    return search.getCost();
+}
+
+template<>
+Cost optimizeValidConfig<1>(GeoDistributedStorageSystem const& gdss, VariableLayout const& layout, std::string slaOption, std::set<int>& config) {
+    MinCostSearch<ValidConfig,Cost> search(ValidConfig(gdss, layout, slaOption), getCost(gdss, layout));
+    config = search.getConfig();
+    return search.getCost();
+}
+
+// Print a data placement
+void printPlacement(std::string const& title, Cost cost, TLL targetLocaleList) {
+    std::cout << "\n" << title << "\n";
+    std::cout << "Data Placement\n";
+    for (int i = 0; i < targetLocaleList["storageTiers"].size(); ++i) 
+        std::cout << targetLocaleList["storageTiers"][i] << " ";
+    std::cout << "\n\n";
+    std::cout << "Target Locale List\n";
+    for (auto const& imap: targetLocaleList) {
+        if (imap.first == "storageTiers") continue;
+        std::cout << imap.first << " -> ";
+        for (auto storageTier: imap.second) std::cout << storageTier << " ";
+        std::cout << "\n";
+    }
+    std::cout << "\nCurrent Cost = " << std::setprecision(10) << cost << "\n";   
+}
+
+// Data placement as a JSON object
+json placementJSON(Cost cost, TLL const& targetLocaleList) {
+    json placement;
+    placement["cost"] = double(cost);
+    placement["storageTiers"] = targetLocaleList.at("storageTiers");
+    placement["targetLocaleList"] = json::object();
+    for (auto const& imap: targetLocaleList) {
+        if (imap.first == "storageTiers") continue;
+        placement["targetLocaleList"][imap.first] = imap.second;
+    }
+    return placement;
+}
+
+// Write optimal data placements as JSON lines as soon as they are found, until maxCount placements
+// are written (no limit if 0) or timeLimit milliseconds have passed (no limit if 0)
+// The deadline is checked before every placement is written, but neither the bottom-up pass of
+// KBestConfig nor a single step to the next placement is interrupted, so either may overrun it
+size_t streamPlacements(DdStructure<2> const& dd, GeoDistributedStorageSystem const& gdss, VariableLayout const& layout,
+                        int maxCount, int timeLimit, bool useMP) {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimit);
+    auto expired = [&]() {
+        return timeLimit > 0 && std::chrono::steady_clock::now() >= deadline;
+    };
+
+    KBestConfig it(dd, getCost(gdss, layout), useMP);
+    size_t count = 0;
+    for (; it.found() && !expired(); it.next()) {
+        json placement = placementJSON(it.getCost(), to_TLL(gdss, layout, it.getConfig()));
+        placement["rank"] = ++count;
+        std::cout << placement.dump() << std::endl;
+
+        if (maxCount > 0 && count >= size_t(maxCount)) break;
+    }
+    return count;
+}
+
+int const SAMPLE_CHUNK = 1 << 16;
+
+// Write count random data placements as JSON lines, drawn SAMPLE_CHUNK at a time in parallel with a
+// random number generator per thread
+size_t samplePlacements(DdStructure<2> const& dd, GeoDistributedStorageSystem const& gdss, VariableLayout const& layout,
+                      size_t count, double beta, int seed, bool useMP) {
+    RandomConfig sampler(dd, getCost(gdss, layout), beta, useMP);
+    if (!sampler.found()) return 0;
+
+    std::vector<std::string> lines(std::min<size_t>(count, SAMPLE_CHUNK));
+#ifdef _OPENMP
+#pragma omp parallel if (useMP)
+#endif
+    {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        std::seed_seq seq {seed, tid};
+        std::mt19937_64 rng(seq);
+        std::set<int> config;
+
+        for (size_t done = 0; done < count; done += lines.size()) {
+            size_t m = std::min(lines.size(), count - done);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (intmax_t k = 0; k < intmax_t(m); ++k) {
+                Cost cost = sampler.draw(rng, config);
+                lines[k] = placementJSON(cost, to_TLL(gdss, layout, config)).dump();
+            }
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+            for (size_t k = 0; k < m; ++k) std::cout << lines[k] << "\n";
+        }
+    }
+    std::cout.flush();
+    return count;
+}
+
+int const BATCH_LANES = 8;
+
+// Write an optimal data placement for each workload as a JSON line
+void evaluateBatch(DdStructure<2> const& dd, GeoDistributedStorageSystem const& gdss, VariableLayout const& layout,
+                   std::vector<json> const& objects, std::vector<std::vector<Cost>> const& laneWeights, bool useMP) {
+    MultiMinCostConfig<BATCH_LANES> optConfigs(dd, laneWeights, useMP);
+    for (int l = 0; l < optConfigs.size(); ++l) {
+        json result = placementJSON(optConfigs.getCost(l), to_TLL(gdss, layout, optConfigs.getConfig(l)));
+        if (dd.empty()) result["cost"] = nullptr;
+        result["object"] = objects[l];
+        std::cout << result.dump() << "\n";
+    }
+}
+
+// Answer a request on the resident instance; constraint changes rebuild the ZDD, a new object workload
+// only replaces the costs, and the top-k placements of the resulting instance are always returned
+json answerRequest(json const& request, GeoDistributedStorageSystem& gdss, VariableLayout const& layout,
+                   std::string& slaOption, DdStructure<2>& dd, bool useMP, std::string const& cacheDir) {
+    json response;
+    if (request.contains("id")) response["id"] = request["id"];
+
+    try {
+        // Apply changes to a copy, so that a bad request leaves the instance as it was
+        GeoDistributedStorageSystem next = gdss;
+        std::string nextSLAOption = slaOption;
+        DdStructure<2> nextDD = dd;
+
+        if (request.contains("goals") || request.contains("strongSLA")) {
+            json goals_data = next.getGoals();
+            if (request.contains("goals")) goals_data.update(request["goals"]);
+            if (request.contains("strongSLA")) nextSLAOption = request["strongSLA"].get<bool>() ? "strong" : "eventual";
+            next.setGoals(goals_data);
+            next.checkAll();
+
+            nextDD = reducedValidConfig(next, layout, nextSLAOption, useMP, cacheDir);
+        }
+        if (request.contains("query")) {
+            next.setQuery(request["query"]);
+            next.checkAll();
+        }
+
+        int k = request.value("k", 1);
+        json placements = json::array();
+        for (KBestConfig it(nextDD, getCost(next, layout), useMP); it.found() && int(placements.size()) < k; it.next()) {
+            placements.push_back(placementJSON(it.getCost(), to_TLL(next, layout, it.getConfig())));
+        }
+
+        gdss = next;
+        slaOption = nextSLAOption;
+        dd = nextDD;
+        response["node"] = dd.size();
+        response["placements"] = placements;
+    }
+    catch (std::exception& e) {
+        response["error"] = e.what();
+    }
+    return response;
+}
+
+// Answer each request line from in with a response line to out
+size_t serveStream(std::istream& in, std::ostream& out, std::function<json(json const&)> const& answer) {
+    size_t count = 0;
+    for (std::string line; getline(in, line); ) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        json request = json::parse(line, nullptr, false);
+        json response = request.is_discarded() ? json {{"error", "ERROR: Invalid JSON request"}} : answer(request);
+        out << response.dump() << std::endl;
+        ++count;
+    }
+    return count;
+}
+
+// Answer request lines from clients connecting to a Unix domain socket at path, one client at a time
+size_t serveSocket(std::string const& path, std::function<json(json const&)> const& answer) {
+    sockaddr_un addr = sockaddr_un();
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("ERROR: Socket path too long " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, path.size());
+
+    // Replace a stale socket left by an earlier server, but never any other file
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            throw std::runtime_error("ERROR: Not a socket " + path);
+        }
+        unlink(path.c_str());
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(server, 16) < 0) {
+        throw std::runtime_error("ERROR: Cannot listen on " + path);
+    }
+
+    size_t count = 0;
+    for (int client; (client = accept(server, 0, 0)) >= 0; close(client)) {
+        std::string buffer;
+        char chunk[4096];
+        for (bool eof = false; !eof; ) {
+            ssize_t n = read(client, chunk, sizeof(chunk));
+            eof = n <= 0;
+            if (!eof) buffer.append(chunk, n);
+
+            // Answer complete lines, and the last one without '\n' when the client has finished
+            size_t end = eof ? buffer.size() : buffer.rfind('\n') + 1;
+            if (end == 0) continue;
+            std::istringstream lines(buffer.substr(0, end));
+            buffer.erase(0, end);
+
+            std::ostringstream responses;
+            count += serveStream(lines, responses, answer);
+            std::string reply = responses.str();
+            for (size_t done = 0; done < reply.size(); ) {
+                ssize_t m = send(client, reply.data() + done, reply.size() - done, MSG_NOSIGNAL);
+                if (m <= 0) break;
+                done += m;
+            }
+        }
+    }
+    close(server);
+    return count;
+}
+
+// Bytes of SAPPOROBDD per node: node table, its share of the per-variable hash tables and the
+// operation cache, and the old table while the node table is being doubled
+size_t const SAPPORO_NODE_BYTES = 64;
+
+// Get the memory limit of this process in bytes from the cgroup, or the physical memory if there is none
+size_t memoryLimit() {
+    size_t limit = size_t(sysconf(_SC_PHYS_PAGES)) * size_t(sysconf(_SC_PAGE_SIZE));
+    for (char const* path: {"/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory/memory.limit_in_bytes"}) {
+        std::ifstream is(path);
+        unsigned long long bytes;
+        if (is >> bytes) limit = std::min<unsigned long long>(limit, bytes);   // "max" if unlimited
+    }
+    return limit;
+}
+
 int main(int argc, char *argv[]) {
     for (unsigned i = 0; i < sizeof(options) / sizeof(options[0]); ++i) {
         opt[options[i][0]] = false;
@@ -67,6 +396,14 @@ int main(int argc, char *argv[]) {
                     opt[s] = true;
                     optNum[s] = std::stoi(argv[++i]);
                 }
+                else if (i + 1 < argc && opt.count(s + " <x>")) {
+                    opt[s] = true;
+                    optReal[s] = std::stod(argv[++i]);
+                }
+                else if (i + 1 < argc && opt.count(s + " <file>")) {
+                    opt[s] = true;
+                    optStr[s] = argv[++i];
+                }
                 else {
                     throw std::exception();
                 }
@@ -87,6 +424,14 @@ int main(int argc, char *argv[]) {
                 throw std::exception();
             }
         }
+
+        // Counts and sizes are used as size_t, where a negative value would wrap around
+        for (char const* s: {"sample", "buffer", "memory", "poolBlock"}) {
+            if (opt[s] && optNum[s] <= 0) throw std::exception();
+        }
+        for (char const* s: {"stream", "timeLimit"}) {
+            if (opt[s] && optNum[s] < 0) throw std::exception();
+        }
     }
     catch (std::exception& e) {
         usage(argv[0]);
@@ -94,6 +439,16 @@ int main(int argc, char *argv[]) {
     }
 
     MessageHandler::showMessages();
+    WorkStealingLoop::useWorkStealing(opt["workStealing"]);
+    WorkStealingLoop::showIdleTime(opt["idleTime"]);
+    if (opt["hugePages"] || opt["hugeTLB"]) {
+        MemoryArena::useHugePages(opt["hugeTLB"] ? MemoryArena::EXPLICIT_PAGES : MemoryArena::TRANSPARENT_PAGES);
+        MemoryArena::setPoolBlockSize(MemoryArena::HUGE_PAGE_SIZE);
+    }
+    if (opt["poolBlock"]) MemoryArena::setPoolBlockSize(size_t(optNum["poolBlock"]) << 10);
+    if (opt["spill"]) {
+        DdStructure<2>::useSpillBuilder(optStr["spill"], size_t(opt["buffer"] ? optNum["buffer"] : 1024) << 20);
+    }
     MessageHandler mh;
     mh.begin("Started");
 
@@ -132,18 +487,69 @@ int main(int argc, char *argv[]) {
         // Determine latency SLA constraint
         std::string slaOption = opt["strongSLA"] ? "strong" : "eventual";
 
+        // Decode ZDD levels into variables once for all consumers
+        VariableLayout layout(gdss);
+
+        // Report the Storage Tiers each requester cannot use under either latency SLA option as a JSON line
+        if (opt["infeasible"]) {
+            ValidConfig spec(gdss, layout, slaOption);
+            int numST = gdss.getNumStorageTiers();
+            json report;
+            for (std::string option: {"eventual", "strong"}) {
+                std::vector<bool> const& feasible = spec.getSLAFeasibility(option);
+                report[option] = json::object();
+                for (int j = 0; j < gdss.getNumDataCenters(); ++j) {
+                    for (int t = 0; t < numST; ++t) {
+                        if (feasible[j * numST + t]) continue;
+                        std::string DCk = gdss.getStorageTiers(t, "dataCenter");
+                        std::string STt = gdss.getStorageTiers(t, "storageTier");
+                        report[option][gdss.getDataCenters(j)].push_back("{" + DCk + ", " + STt + "}");
+                    }
+                }
+            }
+            std::cout << report.dump() << std::endl;
+            mh.end("finished");
+            return 0;
+        }
+
+        // Get an optimal data placement directly from ValidConfig
+        if (opt["optimize"]) {
+            std::set<int> config;
+            Cost optCost = optimizeValidConfig<16>(gdss, layout, slaOption, config);
+            if (optCost == std::numeric_limits<Cost>::infinity()) {
+                mh << "\nNo solutions found\n";
+                return 0;
+            }
+            mh << "\n#variable = " << layout.numVariables()
+                << ", Minimum cost = " << std::fixed << std::setprecision(10) << optCost
+                << "\n";
+            printPlacement("1st Best Placement", optCost, to_TLL(gdss, layout, config));
+            mh.end("finished");
+            return 0;
+        }
+
         // Run ValidConfig
-        ValidConfig spec(gdss, slaOption);
-        DdStructure<2> dd(spec, opt["openMP"]);
-        dd.zddReduce();
+        DdStructure<2> dd;
+        if (opt["load"]) {
+            MessageHandler load;
+            load.begin("Loading " + optStr["load"]);
+            if (!mapZdd(optStr["load"], dd, layout.numVariables(), opt["openMP"], 0, opt["verify"])) {
+                throw std::runtime_error("ERROR: Cannot load ZDD of this instance from " + optStr["load"]);
+            }
+            load.end(dd.size());
+        }
+        else {
+            dd = reducedValidConfig(gdss, layout, slaOption, opt["openMP"], optStr["cache"]);
+        }
+        if (opt["save"] && !saveZdd(dd, optStr["save"], layout.numVariables())) {
+            throw std::runtime_error("ERROR: Cannot save ZDD to " + optStr["save"]);
+        }
 
         // Output ZDD information
         std::string cardinality = dd.evaluate(ZddCardinality<>());
-        CostConfigPair optConfig = dd.evaluate(GetConfig(gdss));
-        TLL targetLocaleList = optConfig.second;
-        Cost currCost = optConfig.first;
+        Cost currCost = dd.evaluate(MinCost(getCost(gdss, layout)));
         if (cardinality == "0") currCost = 0;
-        mh << "\n#variable = " << spec.numVariables()
+        mh << "\n#variable = " << layout.numVariables()
             << ", #node = " << dd.size() 
             << ", #solution = " << cardinality
             << ", Minimum cost = " << std::fixed << std::setprecision(10) << currCost
@@ -159,39 +565,141 @@ int main(int argc, char *argv[]) {
             MessageHandler config;
             config.begin("Finding optimal configurations");
 
-            // Convert to ZBDD and get WeightedIterator
-            BDD_Init(10000, 8000000000LL);
-            for (int i = 0; i < dd.topLevel(); ++i) BDD_NewVar();
-            ZBDD dd_s = dd.evaluate(ToZBDD());
-            weighted_iterator<Cost> it(dd_s, getCost(gdss), false);
-            
-            // Go through ZDD
             std::map<int,std::string> suffix = {{1,"st"}, {2,"nd"}, {3,"rd"}};
-            for (int n = 1; n <= optNum["getconfig"]; ++n) {
-                targetLocaleList = to_TLL(gdss, *it);
-                currCost = it.curr_weight();
-
-                // Print optimal placements
-                if (suffix.count(n) == 0) suffix[n] = "th";
-                std::cout << "\n" << n << suffix[n] << " Best Placement\n";
-                std::cout << "Data Placement\n";
-                for (int i = 0; i < targetLocaleList["storageTiers"].size(); ++i) 
-                    std::cout << targetLocaleList["storageTiers"][i] << " ";
-                std::cout << "\n\n";
-                std::cout << "Target Locale List\n";
-                for (auto const& imap: targetLocaleList) {
-                    if (imap.first == "storageTiers") continue;
-                    std::cout << imap.first << " -> ";
-                    for (auto storageTier: imap.second) std::cout << storageTier << " ";
-                    std::cout << "\n";
+            if (opt["zbdd"]) {
+                // Size the node table for the ZDD and limit it to the memory budget
+                size_t budget = opt["memory"] ? size_t(optNum["memory"]) << 20 : memoryLimit();
+                bddword limit = std::max<bddword>(budget / SAPPORO_NODE_BYTES, 256);
+                if (BDD_Init(std::min<bddword>(2 * dd.size() + 256, limit), limit)) {
+                    throw std::runtime_error("ERROR: Cannot allocate SAPPOROBDD node table");
+                }
+                bddword peak = 0;
+
+                // Convert to ZBDD and get WeightedIterator
+                for (int i = 0; i < dd.topLevel(); ++i) BDD_NewVar();
+                ZBDD dd_s = dd.evaluate(ToZBDD());
+                peak = std::max(peak, BDD_Used());
+                if (dd_s == ZBDD(-1)) {
+                    throw std::runtime_error("ERROR: SAPPOROBDD node table exceeds the memory limit of "
+                                             + std::to_string(limit) + " nodes");
+                }
+                weighted_iterator<Cost> it(dd_s, getCost(gdss, layout), false);
+
+                // Go through ZDD
+                for (int n = 1; n <= optNum["getconfig"]; ++n) {
+                    TLL targetLocaleList = to_TLL(gdss, layout, *it);
+                    currCost = it.curr_weight();
+
+                    // Print optimal placements
+                    if (suffix.count(n) == 0) suffix[n] = "th";
+                    printPlacement(std::to_string(n) + suffix[n] + " Best Placement", currCost, targetLocaleList);
+                    it.next();
+                    peak = std::max(peak, BDD_Used());
+                }
+                mh << "SAPPOROBDD nodes: peak = " << peak << ", limit = " << limit << "\n";
+            }
+            else {
+                // Enumerate placements in order of cost on the ZDD
+                KBestConfig it(dd, getCost(gdss, layout), opt["openMP"]);
+                for (int n = 1; n <= optNum["getconfig"] && it.found(); ++n) {
+                    if (suffix.count(n) == 0) suffix[n] = "th";
+                    printPlacement(std::to_string(n) + suffix[n] + " Best Placement", it.getCost(), to_TLL(gdss, layout, it.getConfig()));
+                    it.next();
                 }
-                std::cout << "\nCurrent Cost = " << std::setprecision(10) << currCost << "\n";   
-                it.next();
             }
 
             config.end("finished");
         }
 
+        // Get all data placements within (1+eps) of the minimum cost
+        if (opt["epsilon"]) {
+            MessageHandler config;
+            config.begin("Finding near-optimal configurations");
+            NearOptimalConfig it(dd, getCost(gdss, layout), optReal["epsilon"], opt["openMP"]);
+            size_t count = 0;
+            for (; it.found(); it.next()) {
+                printPlacement("Placement " + std::to_string(++count), it.getCost(), to_TLL(gdss, layout, it.getConfig()));
+            }
+            config.end(count);
+        }
+
+        // Stream optimal data placements as JSON lines
+        if (opt["stream"]) {
+            MessageHandler stream;
+            stream.begin("Streaming optimal configurations");
+            stream.end(streamPlacements(dd, gdss, layout, optNum["stream"], optNum["timeLimit"], opt["openMP"]));
+        }
+
+        // Draw random data placements as JSON lines
+        if (opt["sample"]) {
+            MessageHandler sample;
+            sample.begin("Sampling configurations");
+            sample.end(samplePlacements(dd, gdss, layout, optNum["sample"], optReal["beta"], optNum["seed"], opt["openMP"]));
+        }
+
+        // Keep the instance and the ZDD in memory and answer requests
+        if (opt["serve"] || opt["socket"]) {
+            std::function<json(json const&)> answer = [&](json const& request) {
+                return answerRequest(request, gdss, layout, slaOption, dd, opt["openMP"], optStr["cache"]);
+            };
+
+            MessageHandler serve;
+            serve.begin("Answering requests");
+            serve.end(opt["socket"] ? serveSocket(optStr["socket"], answer) : serveStream(std::cin, std::cout, answer));
+        }
+
+        // Get an optimal data placement for each object workload on the same ZDD
+        if (opt["batch"]) {
+            std::ifstream workloads(optStr["batch"]);
+            if (!workloads) {
+                throw std::runtime_error("ERROR: Cannot open " + optStr["batch"]);
+            }
+
+            MessageHandler batch;
+            batch.begin("Evaluating object workloads");
+            size_t count = 0;
+            size_t lineNumber = 0;
+            std::vector<json> objects;
+            std::vector<std::vector<Cost>> laneWeights;
+            for (std::string line; getline(workloads, line); ) {
+                ++lineNumber;
+                if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+                json object = lineNumber;
+                try {
+                    // Apply the workload to a copy, so that a bad line leaves the instance as it was
+                    json query_data = json::parse(line);
+                    if (query_data.is_object() && query_data.contains("id")) object = query_data["id"];
+                    GeoDistributedStorageSystem next = gdss;
+                    next.setQuery(query_data);
+                    next.checkAll();
+                    laneWeights.push_back(getCost(next, layout));
+                }
+                catch (std::exception& e) {
+                    // Report the bad line in order after the workloads before it, and go on with the rest
+                    if (!laneWeights.empty()) evaluateBatch(dd, gdss, layout, objects, laneWeights, opt["openMP"]);
+                    objects.clear();
+                    laneWeights.clear();
+                    json result;
+                    result["object"] = object;
+                    result["error"] = e.what();
+                    std::cout << result.dump(-1, ' ', false, json::error_handler_t::replace) << "\n";
+                    continue;
+                }
+
+                objects.push_back(object);
+                ++count;
+
+                // Evaluate BATCH_LANES workloads in a single sweep
+                if (laneWeights.size() == BATCH_LANES) {
+                    evaluateBatch(dd, gdss, layout, objects, laneWeights, opt["openMP"]);
+                    objects.clear();
+                    laneWeights.clear();
+                }
+            }
+            if (!laneWeights.empty()) evaluateBatch(dd, gdss, layout, objects, laneWeights, opt["openMP"]);
+            batch.end(count);
+        }
+
         // Output resulting ZDD
         if (opt["zdd"] && dd.size()) dd.dumpDot(std::cout, "ZDD");
         if (opt["export"] && dd.size()) dd.dumpSapporo(std::cout);